@@ -0,0 +1,78 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+// Print the records of a cix::circular_log file, from oldest to most recent,
+// e.g. after a crash.
+//
+// usage: circular_log_dump [--hex] <file>
+
+#include <cix/cix>
+
+
+static void print_payload(const cix::record_view& payload, bool hex)
+{
+    bool printable = !hex;
+
+    for (std::size_t idx = 0; printable && idx < payload.size; ++idx)
+    {
+        const auto c = payload.data[idx];
+        printable = (c >= 0x20 && c < 0x7f) || c == '\t';
+    }
+
+    if (printable)
+    {
+        fmt::print("{}\n", std::string_view(
+            reinterpret_cast<const char*>(payload.data), payload.size));
+    }
+    else
+    {
+        for (std::size_t idx = 0; idx < payload.size; ++idx)
+            fmt::print("{:02x}", payload.data[idx]);
+        fmt::print("\n");
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    bool hex = false;
+    const char* path = nullptr;
+
+    for (int idx = 1; idx < argc; ++idx)
+    {
+        if (0 == std::strcmp(argv[idx], "--hex"))
+            hex = true;
+        else
+            path = argv[idx];
+    }
+
+    if (!path)
+    {
+        fmt::print(stderr, "usage: circular_log_dump [--hex] <file>\n");
+        return 1;
+    }
+
+    try
+    {
+        cix::circular_log_reader reader(path);
+
+        for (const auto& entry : reader.entries())
+        {
+            fmt::print("#{} ({} bytes): ", entry.seq, entry.payload.size);
+            print_payload(entry.payload, hex);
+        }
+
+        fmt::print(
+            stderr, "{} records, {} corrupted regions, {} loops, {} bytes\n",
+            reader.entries().size(), reader.corrupted(), reader.loops(),
+            reader.capacity());
+    }
+    catch (const std::exception& exc)
+    {
+        fmt::print(stderr, "error: {}\n", exc.what());
+        return 1;
+    }
+
+    return 0;
+}
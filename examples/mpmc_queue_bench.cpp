@@ -0,0 +1,251 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+// Contention benchmark: cix::mpmc_queue versus the mutex-guarded std::queue
+// pattern used by win_namedpipe_server::instance_t::m_output, with polling,
+// blocking and timed operations, the latter two being compared to a
+// mutex + condition variable queue.
+//
+// usage: mpmc_queue_bench [producers [consumers [items_per_producer]]]
+
+#include <cix/cix>
+
+
+// the baselines
+template <typename T>
+class locked_queue
+{
+public:
+    bool try_push(const T& item)
+    {
+        std::scoped_lock lock(m_mutex);
+        m_queue.push(item);
+        return true;
+    }
+
+    bool try_pop(T& item)
+    {
+        std::scoped_lock lock(m_mutex);
+        if (m_queue.empty())
+            return false;
+        item = m_queue.front();
+        m_queue.pop();
+        return true;
+    }
+
+private:
+    std::recursive_mutex m_mutex;
+    std::queue<T> m_queue;
+};
+
+
+template <typename T>
+class condvar_queue
+{
+public:
+    void push(const T& item)
+    {
+        {
+            std::scoped_lock lock(m_mutex);
+            m_queue.push(item);
+        }
+        m_not_empty.notify_one();
+    }
+
+    void pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_empty.wait(lock, [this]() { return !m_queue.empty(); });
+        item = m_queue.front();
+        m_queue.pop();
+    }
+
+    template <typename Rep, typename Period>
+    bool try_push_for(const T& item, const std::chrono::duration<Rep, Period>&)
+    {
+        this->push(item);
+        return true;
+    }
+
+    template <typename Rep, typename Period>
+    bool try_pop_for(T& item, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_not_empty.wait_for(
+                lock, timeout, [this]() { return !m_queue.empty(); }))
+        {
+            return false;
+        }
+        item = m_queue.front();
+        m_queue.pop();
+        return true;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_not_empty;
+    std::queue<T> m_queue;
+};
+
+
+// cix::mpmc_queue is not default constructible
+struct mpmc_queue : cix::mpmc_queue<std::uint64_t>
+{
+    mpmc_queue() : cix::mpmc_queue<std::uint64_t>(1024) { }
+};
+
+
+enum class bench_mode
+{
+    polling,   // try_push() / try_pop() and yield()
+    blocking,  // push() / pop()
+    timed,     // try_push_for() / try_pop_for()
+};
+
+
+template <bench_mode Mode, typename Queue>
+void bench_push(Queue& queue, std::uint64_t item)
+{
+    if constexpr (Mode == bench_mode::polling)
+    {
+        while (!queue.try_push(item))
+            std::this_thread::yield();
+    }
+    else if constexpr (Mode == bench_mode::blocking)
+    {
+        queue.push(item);
+    }
+    else
+    {
+        while (!queue.try_push_for(item, std::chrono::milliseconds(10))) { }
+    }
+}
+
+
+template <bench_mode Mode, typename Queue>
+void bench_pop(Queue& queue, std::uint64_t& item)
+{
+    if constexpr (Mode == bench_mode::polling)
+    {
+        while (!queue.try_pop(item))
+            std::this_thread::yield();
+    }
+    else if constexpr (Mode == bench_mode::blocking)
+    {
+        queue.pop(item);
+    }
+    else
+    {
+        while (!queue.try_pop_for(item, std::chrono::milliseconds(10))) { }
+    }
+}
+
+
+// items are numbered from 1, and each consumer stops at the first 0 it pops,
+// which are pushed once all the producers are done
+template <bench_mode Mode, typename Queue>
+double run(
+    Queue& queue, unsigned producers, unsigned consumers,
+    std::uint64_t items_per_producer)
+{
+    const auto total = items_per_producer * producers;
+    std::atomic<std::uint64_t> checksum{0};
+    std::vector<std::thread> consumer_threads;
+    std::vector<std::thread> producer_threads;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (unsigned idx = 0; idx < consumers; ++idx)
+    {
+        consumer_threads.emplace_back([&]() {
+            std::uint64_t sum = 0;
+            std::uint64_t item;
+
+            for (;;)
+            {
+                bench_pop<Mode>(queue, item);
+                if (!item)
+                    break;
+                sum += item;
+            }
+
+            checksum.fetch_add(sum);
+        });
+    }
+
+    for (unsigned idx = 0; idx < producers; ++idx)
+    {
+        producer_threads.emplace_back([&]() {
+            for (std::uint64_t item = 1; item <= items_per_producer; ++item)
+                bench_push<Mode>(queue, item);
+        });
+    }
+
+    for (auto& thread : producer_threads)
+        thread.join();
+
+    for (unsigned idx = 0; idx < consumers; ++idx)
+        bench_push<Mode>(queue, 0);
+
+    for (auto& thread : consumer_threads)
+        thread.join();
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    const auto expected =
+        producers * (items_per_producer * (items_per_producer + 1) / 2);
+    if (checksum.load() != expected)
+        CIX_THROW_RUNTIME("checksum mismatch");
+
+    return static_cast<double>(total) / elapsed.count();
+}
+
+
+template <bench_mode Mode, typename Queue>
+void print_run(
+    const char* name, unsigned producers, unsigned consumers,
+    std::uint64_t items)
+{
+    Queue queue;
+    const auto rate = run<Mode>(queue, producers, consumers, items);
+    fmt::print("{:<40} {:8.2f} Mitems/s\n", name, rate / 1e6);
+}
+
+
+int main(int argc, char* argv[])
+{
+    unsigned producers = 4;
+    unsigned consumers = 4;
+    std::uint64_t items = 1000000;
+
+    // positive integers only, the parser rejects signs other than '+'
+    if ((argc > 1 && !cix::string::parse(argv[1], producers)) ||
+        (argc > 2 && !cix::string::parse(argv[2], consumers)) ||
+        (argc > 3 && !cix::string::parse(argv[3], items)) ||
+        argc > 4 || !producers || !consumers || !items)
+    {
+        fmt::print(stderr,
+            "usage: mpmc_queue_bench "
+            "[producers [consumers [items_per_producer]]]\n");
+        return 1;
+    }
+
+    print_run<bench_mode::polling, mpmc_queue>(
+        "mpmc_queue try_push/try_pop:", producers, consumers, items);
+    print_run<bench_mode::polling, locked_queue<std::uint64_t>>(
+        "mutex + std::queue:", producers, consumers, items);
+
+    print_run<bench_mode::blocking, mpmc_queue>(
+        "mpmc_queue push/pop:", producers, consumers, items);
+    print_run<bench_mode::blocking, condvar_queue<std::uint64_t>>(
+        "mutex + condvar + std::queue:", producers, consumers, items);
+
+    print_run<bench_mode::timed, mpmc_queue>(
+        "mpmc_queue try_push_for/try_pop_for:", producers, consumers, items);
+    print_run<bench_mode::timed, condvar_queue<std::uint64_t>>(
+        "mutex + condvar + std::queue, timed:", producers, consumers, items);
+
+    return 0;
+}
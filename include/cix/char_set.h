@@ -0,0 +1,149 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+
+// A set of byte values, to search a string for the first or last character
+// that belongs (or not) to the set, like `std::string_view::find_first_of` but
+// without checking every character of the set for every input character.
+//
+// The set is a 256-bit bitmap, laid out as two 16-byte tables indexed by the
+// low nibble of a byte, the bit to test being selected by its high nibble.
+// This allows to classify 16 or 32 bytes at once with a few shuffles when
+// SSSE3 or AVX2 is enabled at compile time. SSE2-only builds compare input
+// against each character of sets of up to 4 characters, and fall back to a
+// scalar lookup otherwise.
+//
+// Construction is constexpr so that a set can be built once, e.g. as a static
+// constant, and reused for every search.
+//
+// CAUTION: only meant for strings of 1-byte characters. UTF-8 strings are
+// supported as long as the set itself is made of ASCII characters.
+class char_set
+{
+public:
+    typedef std::size_t size_type;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+    static constexpr size_type max_small = 4;
+
+public:
+    constexpr char_set() noexcept = default;
+
+    template <
+        typename Char,
+        typename std::enable_if_t<sizeof(Char) == 1, int> = 0>
+    constexpr explicit char_set(std::basic_string_view<Char> chars) noexcept
+    {
+        for (const auto c : chars)
+            this->insert(c);
+    }
+
+    constexpr explicit char_set(const char* chars) noexcept
+        : char_set(std::string_view(chars))
+        { }
+
+    template <
+        typename Char,
+        typename std::enable_if_t<sizeof(Char) == 1, int> = 0>
+    constexpr void insert(Char c) noexcept
+    {
+        const auto b = static_cast<std::uint8_t>(c);
+
+        if (this->contains(b))
+            return;
+
+        m_table[index_of(b)] |= bit_of(b);
+
+        if (m_small < max_small)
+            m_chars[m_small++] = b;
+        else
+            m_small = max_small + 1;
+    }
+
+    constexpr bool empty() const noexcept { return m_small == 0; }
+
+    constexpr bool contains(std::uint8_t b) const noexcept
+    {
+        return (m_table[index_of(b)] & bit_of(b)) != 0;
+    }
+
+    // allow to use a char_set as a predicate, e.g. with string::trim_if()
+    template <typename Char>
+    constexpr bool operator()(Char c) const noexcept
+    {
+        const auto u = static_cast<std::make_unsigned_t<Char>>(c);
+        return u <= 0xff && this->contains(static_cast<std::uint8_t>(u));
+    }
+
+    // offset of the first (or last) character of *data* that is (or is not)
+    // in the set, npos if none
+    size_type find_first(const void* data, size_type size) const noexcept;
+    size_type find_first_not(const void* data, size_type size) const noexcept;
+    size_type find_last(const void* data, size_type size) const noexcept;
+    size_type find_last_not(const void* data, size_type size) const noexcept;
+
+    // same as above, the result is an offset from the beginning of *s*
+    template <typename Char>
+    size_type find_first(std::basic_string_view<Char> s, size_type pos=0) const noexcept
+    {
+        static_assert(sizeof(Char) == 1);
+        if (pos >= s.size())
+            return npos;
+        const auto res = this->find_first(s.data() + pos, s.size() - pos);
+        return (res == npos) ? npos : pos + res;
+    }
+
+    template <typename Char>
+    size_type find_first_not(std::basic_string_view<Char> s, size_type pos=0) const noexcept
+    {
+        static_assert(sizeof(Char) == 1);
+        if (pos >= s.size())
+            return npos;
+        const auto res = this->find_first_not(s.data() + pos, s.size() - pos);
+        return (res == npos) ? npos : pos + res;
+    }
+
+    template <typename Char>
+    size_type find_last(std::basic_string_view<Char> s) const noexcept
+    {
+        static_assert(sizeof(Char) == 1);
+        return this->find_last(s.data(), s.size());
+    }
+
+    template <typename Char>
+    size_type find_last_not(std::basic_string_view<Char> s) const noexcept
+    {
+        static_assert(sizeof(Char) == 1);
+        return this->find_last_not(s.data(), s.size());
+    }
+
+private:
+    // bytes [0x00, 0x7f] are mapped to the first half of the table, bytes
+    // [0x80, 0xff] to the second one
+    static constexpr size_type index_of(std::uint8_t b) noexcept
+    {
+        return (b & 0x0f) | ((b >> 3) & 0x10);
+    }
+
+    static constexpr std::uint8_t bit_of(std::uint8_t b) noexcept
+    {
+        return static_cast<std::uint8_t>(1u << ((b >> 4) & 0x07));
+    }
+
+private:
+    alignas(16) std::uint8_t m_table[32] = {};
+
+    // first characters of the set, for SSE2-only builds
+    std::uint8_t m_chars[max_small] = {};
+
+    // number of characters in the set, or max_small + 1 if greater
+    std::uint8_t m_small = 0;
+};
+
+}  // namespace cix
@@ -0,0 +1,192 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+namespace string {
+
+struct parse_result
+{
+    // number of characters consumed
+    std::size_t length;
+
+    // std::errc() on success, std::errc::invalid_argument if *input* does not
+    // start with a number, std::errc::result_out_of_range if the number does
+    // not fit in the requested type
+    std::errc error;
+};
+
+
+namespace detail::charconv
+{
+    // see charconv.cpp
+    parse_result parse_int(
+        std::string_view input, std::int64_t& out,
+        std::int64_t min, std::int64_t max) noexcept;
+    parse_result parse_uint(
+        std::string_view input, std::uint64_t& out, std::uint64_t max) noexcept;
+    parse_result parse_float(std::string_view input, float& out) noexcept;
+    parse_result parse_float(std::string_view input, double& out) noexcept;
+
+    std::size_t format_int(char* buffer, std::int64_t value) noexcept;
+    std::size_t format_uint(char* buffer, std::uint64_t value) noexcept;
+    std::size_t format_float(char* buffer, float value) noexcept;
+    std::size_t format_float(char* buffer, double value) noexcept;
+
+    template <typename T>
+    inline constexpr bool is_supported_v =
+        (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+        std::is_same_v<T, float> ||
+        std::is_same_v<T, double>;
+
+    // *buffer* must be at least format_max_size<T> long
+    template <typename T>
+    std::size_t format(char* buffer, T value) noexcept
+    {
+        if constexpr (std::is_floating_point_v<T>)
+            return format_float(buffer, value);
+        else if constexpr (std::is_signed_v<T>)
+            return format_int(buffer, value);
+        else
+            return format_uint(buffer, value);
+    }
+}
+
+
+// parse_prefix
+//
+// Parse the number at the beginning of *input*, like std::from_chars(), and
+// store it in *out* on success only. *T* is an integral type other than bool,
+// float or double.
+//
+// Integers are in base 10 with an optional sign. Floating point numbers are
+// in the decimal notation of std::strtod() in the "C" locale, with optional
+// sign, fraction and exponent, or one of inf, infinity, nan and nan(chars),
+// regardless of case. A leading '+' is accepted, blanks are not.
+//
+// Integers are parsed 8 digits at a time. Floating point numbers are
+// correctly rounded, using the Eisel-Lemire algorithm, and a slow path in the
+// rare cases where more than 19 significant digits leave it undecided. A
+// floating point number that rounds to infinity, or to zero while being non
+// null, is out of range.
+template <typename T>
+std::enable_if_t<detail::charconv::is_supported_v<T>, parse_result>
+parse_prefix(std::string_view input, T& out) noexcept
+{
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        return detail::charconv::parse_float(input, out);
+    }
+    else if constexpr (std::is_signed_v<T>)
+    {
+        std::int64_t value;
+        const auto res = detail::charconv::parse_int(
+            input, value,
+            std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+
+        if (res.error == std::errc())
+            out = static_cast<T>(value);
+
+        return res;
+    }
+    else
+    {
+        std::uint64_t value;
+        const auto res = detail::charconv::parse_uint(
+            input, value, std::numeric_limits<T>::max());
+
+        if (res.error == std::errc())
+            out = static_cast<T>(value);
+
+        return res;
+    }
+}
+
+
+// parse
+//
+// Same as parse_prefix() except that the whole of *input* must be a number.
+// Return false on error, in which case *out* is left untouched.
+template <typename T>
+std::enable_if_t<detail::charconv::is_supported_v<T>, bool>
+parse(std::string_view input, T& out) noexcept
+{
+    T value;
+    const auto res = parse_prefix(input, value);
+
+    if (res.error != std::errc() || res.length != input.size())
+        return false;
+
+    out = value;
+    return true;
+}
+
+// same as above, returns an empty std::optional on error
+template <typename T>
+std::enable_if_t<detail::charconv::is_supported_v<T>, std::optional<T>>
+parse(std::string_view input) noexcept
+{
+    T value;
+
+    if (!parse(input, value))
+        return std::nullopt;
+
+    return value;
+}
+
+
+// format_max_size
+//
+// Maximal number of characters written by format_to() for a *T*
+template <typename T>
+inline constexpr std::size_t format_max_size =
+    std::is_same_v<T, float> ? 17 :
+    std::is_same_v<T, double> ? 24 :
+    std::numeric_limits<T>::digits10 + 1 + (std::is_signed_v<T> ? 1 : 0);
+
+
+// format_to
+//
+// Write *value* to *buffer*, whose size is checked at compile time, and return
+// a view of the characters written, e.g.:
+//   char buffer[format_max_size<int>];
+//   std::string_view str = format_to(buffer, 42);
+//
+// *buffer* is not null-terminated. Floating point numbers are written in
+// their shortest form that parses back to the same value, as with
+// std::to_chars() or fmt's "{}".
+template <typename T, std::size_t N>
+std::enable_if_t<detail::charconv::is_supported_v<T>, std::string_view>
+format_to(char (&buffer)[N], T value) noexcept
+{
+    static_assert(N >= format_max_size<T>);
+    return std::string_view(buffer, detail::charconv::format(buffer, value));
+}
+
+// same as above, to [*first*, *last*), return past the last character
+// written, or nullptr if the buffer is too small
+template <typename T>
+std::enable_if_t<detail::charconv::is_supported_v<T>, char*>
+format_to(char* first, char* last, T value) noexcept
+{
+    const auto capacity = static_cast<std::size_t>(last - first);
+
+    if (capacity >= format_max_size<T>)
+        return first + detail::charconv::format(first, value);
+
+    char buffer[format_max_size<T>];
+    const auto length = detail::charconv::format(buffer, value);
+
+    if (length > capacity)
+        return nullptr;
+
+    std::memcpy(first, buffer, length);
+    return first + length;
+}
+
+}  // namespace string
+}  // namespace cix
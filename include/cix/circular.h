@@ -35,6 +35,253 @@ namespace detail::circular
 
     template <typename Container>
     inline constexpr bool is_shrinkable_v = is_shrinkable<Container>::value;
+
+
+    template <typename Container, typename = void>
+    struct is_contiguous : std::false_type { };
+
+    template <typename Container>
+    struct is_contiguous<
+        Container,
+        std::void_t<decltype(std::declval<Container>().data())>>
+        : std::true_type { };
+
+    template <typename Container>
+    inline constexpr bool is_contiguous_v = is_contiguous<Container>::value;
+
+
+    // a contiguous run of items
+    template <typename T>
+    struct segment
+    {
+        T* data = nullptr;
+        std::size_t size = 0;
+
+        constexpr bool empty() const noexcept { return size == 0; }
+        constexpr T* begin() const noexcept { return data; }
+        constexpr T* end() const noexcept { return data + size; }
+    };
+
+
+    // random access iterator, *pos* being relative to the oldest item
+    template <typename Owner, typename Value>
+    class iterator
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef std::remove_const_t<Value> value_type;
+        typedef typename Owner::difference_type difference_type;
+        typedef typename Owner::size_type size_type;
+        typedef Value* pointer;
+        typedef Value& reference;
+
+    public:
+        constexpr iterator() noexcept
+            : m_owner{nullptr}
+            , m_pos{0}
+            { }
+
+        constexpr iterator(Owner* owner, size_type pos) noexcept
+            : m_owner{owner}
+            , m_pos{pos}
+            { }
+
+        // iterator to const_iterator
+        template <
+            typename OtherOwner, typename OtherValue,
+            typename std::enable_if_t<
+                std::is_convertible_v<OtherOwner*, Owner*>, int> = 0>
+        constexpr iterator(const iterator<OtherOwner, OtherValue>& other) noexcept
+            : m_owner{other.owner()}
+            , m_pos{other.pos()}
+            { }
+
+        constexpr Owner* owner() const noexcept { return m_owner; }
+        constexpr size_type pos() const noexcept { return m_pos; }
+
+        constexpr reference operator*() const { return (*m_owner)[m_pos]; }
+        constexpr pointer operator->() const { return &(*m_owner)[m_pos]; }
+
+        constexpr reference operator[](difference_type n) const
+        {
+            return (*m_owner)[this->offset(n)];
+        }
+
+        constexpr iterator& operator++() noexcept { ++m_pos; return *this; }
+        constexpr iterator& operator--() noexcept { --m_pos; return *this; }
+        constexpr iterator operator++(int) noexcept { auto it = *this; ++m_pos; return it; }
+        constexpr iterator operator--(int) noexcept { auto it = *this; --m_pos; return it; }
+
+        constexpr iterator& operator+=(difference_type n) noexcept
+        {
+            m_pos = this->offset(n);
+            return *this;
+        }
+
+        constexpr iterator& operator-=(difference_type n) noexcept
+        {
+            m_pos = this->offset(-n);
+            return *this;
+        }
+
+        constexpr iterator operator+(difference_type n) const noexcept
+        {
+            return iterator(m_owner, this->offset(n));
+        }
+
+        constexpr iterator operator-(difference_type n) const noexcept
+        {
+            return iterator(m_owner, this->offset(-n));
+        }
+
+        friend constexpr iterator operator+(difference_type n, const iterator& it) noexcept
+        {
+            return it + n;
+        }
+
+        template <typename OtherOwner, typename OtherValue>
+        constexpr difference_type operator-(
+            const iterator<OtherOwner, OtherValue>& other) const noexcept
+        {
+            assert(m_owner == other.owner());
+            return
+                static_cast<difference_type>(m_pos) -
+                static_cast<difference_type>(other.pos());
+        }
+
+        template <typename OtherOwner, typename OtherValue>
+        constexpr bool operator==(
+            const iterator<OtherOwner, OtherValue>& other) const noexcept
+        {
+            assert(m_owner == other.owner());
+            return m_pos == other.pos();
+        }
+
+        template <typename OtherOwner, typename OtherValue>
+        constexpr bool operator!=(
+            const iterator<OtherOwner, OtherValue>& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+        template <typename OtherOwner, typename OtherValue>
+        constexpr bool operator<(
+            const iterator<OtherOwner, OtherValue>& other) const noexcept
+        {
+            assert(m_owner == other.owner());
+            return m_pos < other.pos();
+        }
+
+        template <typename OtherOwner, typename OtherValue>
+        constexpr bool operator>(
+            const iterator<OtherOwner, OtherValue>& other) const noexcept
+        {
+            return other < *this;
+        }
+
+        template <typename OtherOwner, typename OtherValue>
+        constexpr bool operator<=(
+            const iterator<OtherOwner, OtherValue>& other) const noexcept
+        {
+            return !(other < *this);
+        }
+
+        template <typename OtherOwner, typename OtherValue>
+        constexpr bool operator>=(
+            const iterator<OtherOwner, OtherValue>& other) const noexcept
+        {
+            return !(*this < other);
+        }
+
+    private:
+        constexpr size_type offset(difference_type n) const noexcept
+        {
+            return static_cast<size_type>(static_cast<difference_type>(m_pos) + n);
+        }
+
+    private:
+        Owner* m_owner;
+        size_type m_pos;
+    };
+
+
+    // Reductions over a contiguous segment.
+    //
+    // Items are dispatched over *lanes* independent accumulators, so that the
+    // loops have no dependency from one iteration to the next and can be
+    // vectorized by the compiler, including for floating point types since
+    // the order of operations within each lane is fixed.
+    inline constexpr std::size_t lanes = 8;
+
+    template <typename Acc, typename T>
+    inline Acc reduce_sum(const T* items, std::size_t count, Acc acc) noexcept
+    {
+        Acc lane[lanes] = {};
+        std::size_t idx = 0;
+
+        for (; idx + lanes <= count; idx += lanes)
+        {
+            for (std::size_t l = 0; l < lanes; ++l)
+                lane[l] += static_cast<Acc>(items[idx + l]);
+        }
+
+        for (; idx < count; ++idx)
+            lane[0] += static_cast<Acc>(items[idx]);
+
+        for (std::size_t l = 0; l < lanes; ++l)
+            acc += lane[l];
+
+        return acc;
+    }
+
+    // *select* returns the preferred of its two arguments
+    template <typename T, typename Select>
+    inline T reduce_select(
+        const T* items, std::size_t count, T acc, Select select) noexcept
+    {
+        T lane[lanes];
+        std::size_t idx = 0;
+
+        for (std::size_t l = 0; l < lanes; ++l)
+            lane[l] = acc;
+
+        for (; idx + lanes <= count; idx += lanes)
+        {
+            for (std::size_t l = 0; l < lanes; ++l)
+                lane[l] = select(lane[l], items[idx + l]);
+        }
+
+        for (; idx < count; ++idx)
+            lane[0] = select(lane[0], items[idx]);
+
+        for (std::size_t l = 0; l < lanes; ++l)
+            acc = select(acc, lane[l]);
+
+        return acc;
+    }
+
+    template <typename T, typename Pred>
+    inline std::size_t reduce_count_if(
+        const T* items, std::size_t count, Pred& pred)
+    {
+        std::size_t lane[lanes] = {};
+        std::size_t idx = 0;
+
+        for (; idx + lanes <= count; idx += lanes)
+        {
+            for (std::size_t l = 0; l < lanes; ++l)
+                lane[l] += pred(items[idx + l]) ? 1 : 0;
+        }
+
+        for (; idx < count; ++idx)
+            lane[0] += pred(items[idx]) ? 1 : 0;
+
+        std::size_t total = 0;
+        for (std::size_t l = 0; l < lanes; ++l)
+            total += lane[l];
+
+        return total;
+    }
 }
 
 
@@ -59,37 +306,61 @@ public:
     typedef value_type* pointer;
     typedef const value_type* const_pointer;
 
+    typedef detail::circular::iterator<circular, value_type> iterator;
+    typedef detail::circular::iterator<const circular, const value_type> const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    typedef detail::circular::segment<value_type> segment_type;
+    typedef detail::circular::segment<const value_type> const_segment_type;
+
+    // accumulator type of sum(): 64-bit for integral types
+    typedef std::conditional_t<
+        std::is_integral_v<ElementT> && !std::is_same_v<ElementT, bool>,
+        std::conditional_t<
+            std::is_signed_v<ElementT>, std::int64_t, std::uint64_t>,
+        ElementT> sum_type;
+
     static constexpr size_type initial_capacity = InitialCapacity;
     static constexpr bool resizable = detail::circular::is_resizable_v<Container>;
 
+    // power-of-two mode: with a fixed capacity that is a power of two, indexes
+    // wrap around by masking
+    // otherwise, since an index to wrap is always less than twice the
+    // capacity, a conditional subtraction is enough and modulo is never needed
+    static constexpr bool pow2_capacity =
+        !resizable &&
+        initial_capacity > 0 &&
+        (initial_capacity & (initial_capacity - 1)) == 0;
+
 
 public:
     circular()
         : m_capacity{initial_capacity}
-        , m_wpos{0}
-        , m_loops{0}
+        , m_head{0}
+        , m_size{0}
     {
         static_assert(initial_capacity <= std::numeric_limits<difference_type>::max());
 
         if constexpr (resizable)
-            this->resize(initial_capacity);
+            m_container.resize(initial_capacity);
     }
 
     ~circular() = default;
 
     constexpr bool empty() const noexcept
     {
-        return !(m_wpos | m_loops);
+        return m_size == 0;
     }
 
     constexpr bool full() const noexcept
     {
-        return 0 != m_loops;
+        return m_size == m_capacity;
     }
 
     constexpr size_type size() const noexcept
     {
-        return (m_loops > 0) ? m_capacity : m_wpos;
+        return m_size;
     }
 
     constexpr size_type capacity() const noexcept
@@ -100,42 +371,136 @@ public:
 
     constexpr void clear() noexcept
     {
-        m_wpos = 0;
-        m_loops = 0;
+        m_head = 0;
+        m_size = 0;
     }
 
+    // push an item, overwrite the oldest one if full
     constexpr void push_back(const_reference item) noexcept
     {
         assert(m_capacity > 0);
-        assert(m_wpos <= m_capacity);
         if (m_capacity > 0)
         {
-            if (m_wpos >= m_capacity)
-            {
-                m_wpos = 0;
-                if (!++m_loops)  // overflow?
-                    ++m_loops;
-            }
-            m_container[m_wpos++] = item;
+            m_container[this->wrap(m_head + m_size)] = item;
+            this->commit_push();
         }
     }
 
+    // push an item, overwrite the oldest one if full
     constexpr void push_back(value_type&& item) noexcept
     {
         assert(m_capacity > 0);
-        assert(m_wpos <= m_capacity);
         if (m_capacity > 0)
         {
-            if (m_wpos >= m_capacity)
-            {
-                m_wpos = 0;
-                if (!++m_loops)  // overflow?
-                    ++m_loops;
-            }
-            m_container[m_wpos++] = std::move(item);
+            m_container[this->wrap(m_head + m_size)] = std::move(item);
+            this->commit_push();
+        }
+    }
+
+    // Push *count* items, overwrite the oldest ones if needed.
+    //
+    // Copy is split in at most two contiguous segments. With a trivially
+    // copyable value_type and a contiguous container (std::array and
+    // std::vector), each segment is a plain memmove.
+    constexpr void push_back_n(const_pointer items, size_type count) noexcept
+    {
+        assert(items || !count);
+        assert(m_capacity > 0);
+        if (!count || !m_capacity)
+            return;
+
+        // only the most recent items would remain anyway
+        if (count >= m_capacity)
+        {
+            std::copy_n(
+                items + (count - m_capacity),
+                m_capacity,
+                m_container.begin());
+            m_head = 0;
+            m_size = m_capacity;
+            return;
+        }
+
+        const auto tail = this->wrap(m_head + m_size);
+        const auto first = std::min(count, m_capacity - tail);
+
+        std::copy_n(
+            items, first,
+            std::next(m_container.begin(), static_cast<difference_type>(tail)));
+        std::copy_n(items + first, count - first, m_container.begin());
+
+        const auto new_size = m_size + count;
+        if (new_size > m_capacity)
+        {
+            m_head = this->wrap(m_head + (new_size - m_capacity));
+            m_size = m_capacity;
+        }
+        else
+        {
+            m_size = new_size;
+        }
+    }
+
+    // Copy up to *count* items to *dest*, starting at *pos* (0 being the
+    // oldest item), in at most two contiguous segments.
+    // Returns the number of items copied.
+    constexpr size_type copy_out(
+        size_type pos,
+        pointer dest,
+        size_type count) const noexcept
+    {
+        assert(dest || !count);
+        assert(pos <= m_size);
+        if (pos >= m_size)
+            return 0;
+
+        count = std::min(count, m_size - pos);
+
+        const auto start = this->wrap(m_head + pos);
+        const auto first = std::min(count, m_capacity - start);
+
+        std::copy_n(
+            std::next(m_container.begin(), static_cast<difference_type>(start)),
+            first, dest);
+        std::copy_n(m_container.begin(), count - first, dest + first);
+
+        return count;
+    }
+
+    // drop the oldest item
+    // CAUTION: item is not destroyed, only overwritten by subsequent pushes
+    constexpr void pop_front() noexcept
+    {
+        assert(!this->empty());
+        if (m_size > 0)
+        {
+            m_head = this->wrap(m_head + 1);
+            --m_size;
         }
     }
 
+    // drop up to *count* oldest items, return the number of dropped items
+    // CAUTION: items are not destroyed, only overwritten by subsequent pushes
+    constexpr size_type pop_front_n(size_type count) noexcept
+    {
+        count = std::min(count, m_size);
+        if (count > 0)
+        {
+            m_head = this->wrap(m_head + count);
+            m_size -= count;
+        }
+        return count;
+    }
+
+    // drop the most recent item
+    // CAUTION: item is not destroyed, only overwritten by subsequent pushes
+    constexpr void pop_back() noexcept
+    {
+        assert(!this->empty());
+        if (m_size > 0)
+            --m_size;
+    }
+
     constexpr const_reference front() const noexcept
     {
         return (*this)[0];  // oldest pos
@@ -170,16 +535,127 @@ public:
     {
         assert(!this->empty());
         assert(pos < this->size());
-        const auto idx = m_loops ? m_wpos % m_capacity + pos : pos;
-        return m_container[idx];
+        return m_container[this->wrap(m_head + pos)];
     }
 
     constexpr const_reference operator[](size_type pos) const
     {
         assert(!this->empty());
         assert(pos < this->size());
-        const auto idx = m_loops ? m_wpos % m_capacity + pos : pos;
-        return m_container[idx];
+        return m_container[this->wrap(m_head + pos)];
+    }
+
+    // iterators, from oldest to most recent item
+    // CAUTION: like indexes, iterators are invalidated by push and pop
+    // operations
+    constexpr iterator begin() noexcept { return iterator(this, 0); }
+    constexpr iterator end() noexcept { return iterator(this, m_size); }
+    constexpr const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    constexpr const_iterator end() const noexcept { return const_iterator(this, m_size); }
+    constexpr const_iterator cbegin() const noexcept { return this->begin(); }
+    constexpr const_iterator cend() const noexcept { return this->end(); }
+    constexpr reverse_iterator rbegin() noexcept { return reverse_iterator(this->end()); }
+    constexpr reverse_iterator rend() noexcept { return reverse_iterator(this->begin()); }
+    constexpr const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(this->end()); }
+    constexpr const_reverse_iterator rend() const noexcept { return const_reverse_iterator(this->begin()); }
+    constexpr const_reverse_iterator crbegin() const noexcept { return this->rbegin(); }
+    constexpr const_reverse_iterator crend() const noexcept { return this->rend(); }
+
+    // The (at most) two contiguous segments of items, oldest items first.
+    // Second segment is empty unless items wrap around the end of the
+    // container.
+    template <typename Dummy = Container>
+    typename std::enable_if_t<
+        detail::circular::is_contiguous_v<Dummy>,
+        std::array<segment_type, 2>>
+    segments() noexcept
+    {
+        const auto first = std::min(m_size, m_capacity - m_head);
+        return {
+            segment_type{ m_container.data() + m_head, first },
+            segment_type{ m_container.data(), m_size - first } };
+    }
+
+    template <typename Dummy = Container>
+    typename std::enable_if_t<
+        detail::circular::is_contiguous_v<Dummy>,
+        std::array<const_segment_type, 2>>
+    segments() const noexcept
+    {
+        const auto first = std::min(m_size, m_capacity - m_head);
+        return {
+            const_segment_type{ m_container.data() + m_head, first },
+            const_segment_type{ m_container.data(), m_size - first } };
+    }
+
+    // Whole-window reductions, run over segments() so that loops can be
+    // vectorized.
+    // sum() of an empty window is zero, min() and max() require a non-empty
+    // window.
+    template <typename Acc = sum_type, typename Dummy = Container>
+    typename std::enable_if_t<
+        detail::circular::is_contiguous_v<Dummy>,
+        Acc>
+    sum() const noexcept
+    {
+        Acc acc{};
+        for (const auto& seg : this->segments())
+            acc = detail::circular::reduce_sum<Acc>(seg.data, seg.size, acc);
+        return acc;
+    }
+
+    template <typename Dummy = Container>
+    typename std::enable_if_t<
+        detail::circular::is_contiguous_v<Dummy>,
+        value_type>
+    min() const noexcept
+    {
+        assert(!this->empty());
+        if (this->empty())
+            return value_type{};
+
+        auto acc = this->front();
+        for (const auto& seg : this->segments())
+        {
+            acc = detail::circular::reduce_select(
+                seg.data, seg.size, acc,
+                [](const value_type& a, const value_type& b) {
+                    return (b < a) ? b : a; });
+        }
+        return acc;
+    }
+
+    template <typename Dummy = Container>
+    typename std::enable_if_t<
+        detail::circular::is_contiguous_v<Dummy>,
+        value_type>
+    max() const noexcept
+    {
+        assert(!this->empty());
+        if (this->empty())
+            return value_type{};
+
+        auto acc = this->front();
+        for (const auto& seg : this->segments())
+        {
+            acc = detail::circular::reduce_select(
+                seg.data, seg.size, acc,
+                [](const value_type& a, const value_type& b) {
+                    return (a < b) ? b : a; });
+        }
+        return acc;
+    }
+
+    template <typename Pred, typename Dummy = Container>
+    typename std::enable_if_t<
+        detail::circular::is_contiguous_v<Dummy>,
+        size_type>
+    count_if(Pred pred) const
+    {
+        size_type count = 0;
+        for (const auto& seg : this->segments())
+            count += detail::circular::reduce_count_if(seg.data, seg.size, pred);
+        return count;
     }
 
     template <typename Dummy = Container>
@@ -195,98 +671,64 @@ public:
 
         if (new_capacity <= 0)
         {
-            m_container.resize(1);
+            m_container.clear();
             m_capacity = 0;
-            m_wpos = 0;
-            m_loops = 0;
+            m_head = 0;
+            m_size = 0;
         }
         else if (this->empty())
         {
-            assert(!m_wpos);
-            assert(!m_loops);
             m_container.resize(new_capacity);
             m_capacity = new_capacity;
-            m_wpos = 0;
-            m_loops = 0;
+            m_head = 0;
+            m_size = 0;
         }
-        else if (0 == m_loops)
+        else if (m_head + m_size <= std::min(m_capacity, new_capacity))
         {
+            // items are contiguous and remain in bounds
             // CAUTION: m_container.resize() is assumed not to destroy first
             // items (i.e. std::vector supported)
             m_container.resize(new_capacity);
-            if (new_capacity <= m_capacity)
-                m_wpos = m_wpos % (new_capacity + 1);
             m_capacity = new_capacity;
         }
         else
         {
-            assert(m_loops > 0);
-            assert(this->size() == m_capacity);  // because m_loops > 0
-
-            const size_type new_size = std::min(new_capacity, m_capacity);
+            // if new_capacity < m_size, keep the most recent entries only
+            const size_type new_size = std::min(new_capacity, m_size);
+            const size_type skip = m_size - new_size;
             container_type new_container;
-            size_type new_wpos = 0;
 
             // do not assume constructor is standard, call resize() explicitly
             new_container.resize(new_capacity);
 
-            // move the tail of source buffer to the head of dest buffer
-            // if new_capacity < m_capacity, keep the most recent entries only
-            if (m_wpos < m_capacity && new_size > m_wpos)
-            {
-                const auto pos = m_wpos + (m_capacity - new_size);
-
-                assert(pos < m_capacity);
-
-                std::move(
-                    // std::execution::par_unseq,  // C++20
-                    std::next(
-                        m_container.begin(),
-                        static_cast<difference_type>(pos)),
-                    std::next(
-                        m_container.begin(),
-                        static_cast<difference_type>(m_capacity)),
-                    new_container.begin());
-
-                new_wpos += m_capacity - pos;
-
-                assert(new_wpos <= new_size);
-                assert(new_wpos <= new_capacity);
-            }
-
-            // move the head of source buffer to the tail of dest buffer
-            // if new_capacity < m_capacity, keep the most recent entries only
-            if (m_wpos > 0 && new_size > new_wpos)
-            {
-                const auto pos = m_wpos - (new_size - new_wpos);
-
-                assert(pos >= 0);
-                assert(pos < m_capacity);
-                assert(pos < m_wpos);
-
-                std::move(
-                    // std::execution::par_unseq,  // C++20
-                    std::next(
-                        m_container.begin(),
-                        static_cast<difference_type>(pos)),
-                    std::next(
-                        m_container.begin(),
-                        static_cast<difference_type>(m_wpos)),
-                    new_container.begin());
-
-                new_wpos += m_wpos - pos;
-
-                assert(new_wpos <= new_size);
-                assert(new_wpos <= new_capacity);
-            }
-
-            assert(new_wpos <= new_size);
-            assert(new_wpos <= new_capacity);
+            // move items to the head of dest buffer, in at most two segments
+            const auto start = this->wrap(m_head + skip);
+            const auto first = std::min(new_size, m_capacity - start);
+
+            std::move(
+                // std::execution::par_unseq,  // C++20
+                std::next(
+                    m_container.begin(),
+                    static_cast<difference_type>(start)),
+                std::next(
+                    m_container.begin(),
+                    static_cast<difference_type>(start + first)),
+                new_container.begin());
+
+            std::move(
+                // std::execution::par_unseq,  // C++20
+                m_container.begin(),
+                std::next(
+                    m_container.begin(),
+                    static_cast<difference_type>(new_size - first)),
+                std::next(
+                    new_container.begin(),
+                    static_cast<difference_type>(first)));
 
             m_container.swap(new_container);
             m_capacity = new_capacity;
-            m_wpos = new_wpos;
-            m_loops = 0;
+            m_head = 0;
+            m_size = new_size;
         }
     }
 
@@ -305,11 +747,35 @@ public:
     }
 
 
+private:
+    // *idx* must be less than twice the capacity
+    constexpr size_type wrap(size_type idx) const noexcept
+    {
+        if constexpr (pow2_capacity)
+        {
+            return idx & (initial_capacity - 1);
+        }
+        else
+        {
+            assert(idx < 2 * m_capacity);
+            return (idx >= m_capacity) ? idx - m_capacity : idx;
+        }
+    }
+
+    // branch-free update of the cursors after an item has been written
+    constexpr void commit_push() noexcept
+    {
+        const size_type was_full = (m_size == m_capacity) ? 1 : 0;
+        m_head = this->wrap(m_head + was_full);
+        m_size += 1 - was_full;
+    }
+
+
 private:
     container_type m_container;
     size_type m_capacity;
-    size_type m_wpos;
-    size_type m_loops;
+    size_type m_head;  // oldest item
+    size_type m_size;
 };
 
 
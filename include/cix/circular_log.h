@@ -0,0 +1,155 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+
+namespace detail::circular_log
+{
+    class file_mapping;
+}
+
+
+// A file-backed circular log of records, typically used as a flight recorder:
+// the last *capacity* bytes of diagnostic events survive a crash of the
+// process since they are written straight to a shared memory mapping of the
+// file.
+//
+// File starts with a 64-byte header holding the write cursor, the number of
+// times the log has looped, and the sequence number of the next record. The
+// data area that follows is filled with records, each laid out as follows
+// (integers in native byte order, records aligned to 4 bytes):
+//
+//   std::uint32_t magic     // circular_log::record_magic
+//   std::uint32_t crc32     // crc32 of the fields below and payload
+//   std::uint64_t seq       // sequence number
+//   std::uint32_t size      // size of payload
+//   std::uint8_t  payload[size]
+//   std::uint8_t  padding[]  // zeros
+//
+// A record that does not fit at the end of the data area is written at its
+// beginning, and the tail is zeroed. Likewise, the remainder of an old record
+// partially overwritten by a new one is zeroed, so that only actual corruption
+// is reported by the reader.
+//
+// Records can be of fixed or variable size. Use `circular_log_reader` to
+// reconstruct the ordered history after a restart.
+//
+// write() is thread-safe. It only costs a memcpy and a crc32 of the payload,
+// no system call. Call flush() to have data reach the disk, e.g. if it must
+// survive a power loss as well.
+class circular_log
+{
+public:
+    typedef std::size_t size_type;
+    typedef std::uint64_t seq_type;
+
+    static constexpr size_type header_size = 64;
+    static constexpr size_type record_header_size = 20;
+    static constexpr size_type record_alignment = 4;
+    static constexpr std::uint32_t record_magic = 0x474f4c43;  // "CLOG"
+
+public:
+    CIX_NONCOPYABLE(circular_log)
+
+    circular_log() noexcept;
+
+    // see open()
+    circular_log(const std::string& path, size_type capacity);
+
+    ~circular_log();
+
+    // Open an existing log or create a new one, *capacity* being the size of
+    // the data area.
+    //
+    // An existing log is resumed where it stopped if its header is valid and
+    // its capacity is the same. Otherwise it is reset.
+    //
+    // *path* is expected to be UTF-8 encoded.
+    void open(const std::string& path, size_type capacity);
+
+    void close() noexcept;
+
+    bool is_open() const noexcept;
+
+    size_type capacity() const noexcept;
+    size_type cursor() const noexcept;
+    std::uint64_t loops() const noexcept;
+    seq_type next_seq() const noexcept;
+
+    // size of a record holding a payload of *size* bytes
+    // the size of a payload is stored on 32 bits, so write() rejects payloads
+    // bigger than max_payload_size even if the log is big enough
+    static constexpr size_type max_payload_size =
+        std::numeric_limits<std::uint32_t>::max();
+
+    static constexpr size_type frame_size(size_type size) noexcept
+    {
+        return
+            (record_header_size + size + record_alignment - 1) &
+            ~(record_alignment - 1);
+    }
+
+    // append a record, return its sequence number
+    seq_type write(const void* data, size_type size);
+    seq_type write(std::string_view data);
+
+    // write dirty pages to disk
+    void flush(bool async=false);
+
+private:
+    std::unique_ptr<detail::circular_log::file_mapping> m_file;
+    std::uint8_t* m_data;
+    size_type m_capacity;
+    std::mutex m_mutex;
+};
+
+
+// Read the records of a `circular_log` file, ordered from oldest to most
+// recent.
+//
+// Records that are corrupted, or that were partially overwritten when the log
+// looped, are skipped.
+//
+// CAUTION: the file is mapped read-only, so records must not be accessed after
+// the reader is destroyed.
+class circular_log_reader
+{
+public:
+    typedef circular_log::size_type size_type;
+    typedef circular_log::seq_type seq_type;
+
+    struct entry
+    {
+        seq_type seq;
+        record_view payload;
+    };
+
+public:
+    CIX_NONCOPYABLE(circular_log_reader)
+
+    // *path* is expected to be UTF-8 encoded
+    explicit circular_log_reader(const std::string& path);
+    ~circular_log_reader();
+
+    size_type capacity() const noexcept;
+    std::uint64_t loops() const noexcept;
+
+    const std::vector<entry>& entries() const noexcept;
+
+    // number of corrupted regions skipped
+    size_type corrupted() const noexcept;
+
+private:
+    std::unique_ptr<detail::circular_log::file_mapping> m_file;
+    size_type m_capacity;
+    std::uint64_t m_loops;
+    std::vector<entry> m_entries;
+    size_type m_corrupted;
+};
+
+}  // namespace cix
@@ -66,18 +66,30 @@
 #include "std_utils.h"
 #include "noncopyable.h"
 #include "endian.h"
+#include "detail/bits.h"
 #include "win_deleters.h"
 #include "best_fit.h"
 #include "circular.h"
+#include "mirrored_ring.h"
+#include "window_stats.h"
 
 // string utils
+#include "char_set.h"
 #include "string.h"
+#include "searcher.h"
+#include "multi_replacer.h"
 #include "path.h"
+#include "glob.h"
+#include "charconv.h"
+#include "intern_pool.h"
 #include "wstr.h"
 
 // stream utils
 #include "memstream.h"
 #include "memstreambuf.h"
+#include "compressed_memstream.h"
+#include "record.h"
+#include "circular_log.h"
 
 // time utils
 #include "monotonic.h"
@@ -88,9 +100,18 @@
 // hash methods
 #include "crc32.h"
 
+// compression
+#include "lz.h"
+
 // threading
 #include "thread.h"
 #include "lock_guard.h"
+#include "spsc_ring.h"
+#include "mpmc_queue.h"
+#include "rate_window.h"
+
+// file system
+#include "walk.h"
 
 // windows specific
 #include "win_console.h"
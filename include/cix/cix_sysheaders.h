@@ -47,8 +47,10 @@
 #include <limits>
 #include <locale>
 #include <memory>
+#include <optional>
 #include <random>
 #include <stdexcept>
+#include <system_error>
 #include <type_traits>
 #include <utility>
 
@@ -71,20 +73,52 @@
 
 // c++ threading
 #include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
 
 // linux extra headers
 #ifdef __linux__
     #include <endian.h>
+    #include <sys/syscall.h>
 #endif
 
 // posix headers
 #ifndef _WIN32
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
     #include <time.h>
+    #include <unistd.h>
 #endif
 
 // windows extra headers
 #ifdef _WIN32
     #include <io.h>
 #endif
+
+// x86 intrinsics
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+    #include <immintrin.h>
+#endif
+
+// instruction sets that can be used without runtime detection
+#if defined(__AVX2__)
+    #define CIX_HAS_AVX2  1
+#else
+    #define CIX_HAS_AVX2  0
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__) || defined(__AVX2__)
+    #define CIX_HAS_SSSE3  1
+#else
+    #define CIX_HAS_SSSE3  0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CIX_HAS_SSE2  1
+#else
+    #define CIX_HAS_SSE2  0
+#endif
@@ -0,0 +1,108 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+
+// A compression stage on top of a `cix::memstream`.
+//
+// Written data is buffered and compressed with `cix::lz` each time a block
+// fills up, straight into the underlying stream's buffer. Read data is
+// decompressed lazily, one block at a time, as the read cursor moves forward.
+//
+// Each block is stored as follows (integers in native byte order, like
+// `memstream` does):
+//
+//   std::uint32_t raw_size     // size of the uncompressed data
+//   std::uint32_t packed_size  // size of payload; == raw_size if stored as-is
+//   std::uint32_t crc32        // crc32 of the two fields above and payload
+//   std::uint8_t  payload[packed_size]
+//
+// Blocks that do not compress are stored as-is. A `std::runtime_error` is
+// thrown on read if a block is truncated or fails its integrity check.
+//
+// A reader rejects blocks whose raw_size is greater than its own block size, as
+// a guard against corrupted headers. Data must therefore be read with a block
+// size at least as big as the one it was written with.
+//
+// CAUTION: the last, partially filled block is only written to the underlying
+// stream by flush() or by the destructor. The destructor swallows errors, so
+// call flush() explicitly to get them.
+class compressed_memstream
+{
+public:
+    typedef memstream::size_type size_type;
+
+    enum : size_type { default_block_size = 64 * 1024 };
+    enum : size_type { block_header_size = 3 * sizeof(std::uint32_t) };
+
+public:
+    CIX_NONCOPYABLE(compressed_memstream)
+
+    explicit compressed_memstream(
+        memstream& stream,
+        size_type block_size=default_block_size);
+
+    // flush() pending data, ignoring errors
+    ~compressed_memstream();
+
+    memstream& stream();
+    size_type block_size() const;
+
+    // generic i/o
+    compressed_memstream& write(const void* data, size_type size);
+    compressed_memstream& read(void* dest, size_type size);
+
+    // single byte i/o
+    compressed_memstream& write(const std::uint8_t value);
+    compressed_memstream& read(std::uint8_t& value);
+
+    // integral type write
+    template <typename T>
+    std::enable_if_t<
+        std::is_integral<T>::value && sizeof(T) >= 2,
+        compressed_memstream&>
+    write(const T value)
+    {
+        return this->write(&value, sizeof(value));
+    }
+
+    // integral type read
+    template <typename T>
+    std::enable_if_t<
+        std::is_integral<T>::value && sizeof(T) >= 2,
+        compressed_memstream&>
+    read(T& value)
+    {
+        return this->read(&value, sizeof(value));
+    }
+
+    // compress and write pending data, if any, as a block of its own
+    compressed_memstream& flush();
+
+    // true if there is no more data to read, either decompressed or not
+    bool eof() const;
+
+protected:
+    void write_block(const std::uint8_t* data, size_type size);
+    bool read_block();
+
+protected:
+    memstream& m_stream;
+    size_type m_block_size;
+
+    // write side
+    std::vector<std::uint8_t> m_wbuf;
+    size_type m_wlen;
+
+    // read side
+    std::vector<std::uint8_t> m_rbuf;
+    size_type m_rpos;
+    size_type m_rlen;
+};
+
+}  // namespace cix
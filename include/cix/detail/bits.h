@@ -0,0 +1,142 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "ensure_cix.h"
+
+// bit scan and hash mixing helpers shared by the implementation files
+
+namespace cix {
+namespace detail {
+
+// index of the lowest bit set in *mask*, which must not be null
+inline unsigned lowest_bit(std::uint32_t mask) noexcept
+{
+    assert(mask != 0);
+
+#if CIX_COMPILER_CLANG || CIX_COMPILER_GCC || CIX_COMPILER_INTEL
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#elif CIX_COMPILER_MSVC
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return static_cast<unsigned>(idx);
+#else
+    unsigned n = 0;
+    for (; !(mask & 1); mask >>= 1)
+        ++n;
+    return n;
+#endif
+}
+
+inline unsigned lowest_bit(std::uint64_t mask) noexcept
+{
+    assert(mask != 0);
+
+#if CIX_COMPILER_CLANG || CIX_COMPILER_GCC || CIX_COMPILER_INTEL
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#elif CIX_COMPILER_MSVC && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64(&idx, mask);
+    return static_cast<unsigned>(idx);
+#else
+    unsigned n = 0;
+    for (; !(mask & 1); mask >>= 1)
+        ++n;
+    return n;
+#endif
+}
+
+
+// index of the highest bit set in *mask*, which must not be null
+inline unsigned highest_bit(std::uint32_t mask) noexcept
+{
+    assert(mask != 0);
+
+#if CIX_COMPILER_CLANG || CIX_COMPILER_GCC || CIX_COMPILER_INTEL
+    return 31u - static_cast<unsigned>(__builtin_clz(mask));
+#elif CIX_COMPILER_MSVC
+    unsigned long idx;
+    _BitScanReverse(&idx, mask);
+    return static_cast<unsigned>(idx);
+#else
+    unsigned n = 31;
+    for (; !(mask & 0x80000000u); mask <<= 1)
+        --n;
+    return n;
+#endif
+}
+
+inline unsigned highest_bit(std::uint64_t mask) noexcept
+{
+    assert(mask != 0);
+
+#if CIX_COMPILER_CLANG || CIX_COMPILER_GCC || CIX_COMPILER_INTEL
+    return 63u - static_cast<unsigned>(__builtin_clzll(mask));
+#elif CIX_COMPILER_MSVC && defined(_M_X64)
+    unsigned long idx;
+    _BitScanReverse64(&idx, mask);
+    return static_cast<unsigned>(idx);
+#else
+    unsigned n = 63;
+    for (; !(mask & 0x8000000000000000ull); mask <<= 1)
+        --n;
+    return n;
+#endif
+}
+
+
+// one round of FxHash-like mixing of *word* into *h*
+constexpr std::uint64_t fx_mix(std::uint64_t h, std::uint64_t word) noexcept
+{
+    return (((h << 5) | (h >> 59)) ^ word) * 0x51'7c'c1'b7'27'22'0a'95ull;
+}
+
+
+// fmix64 from MurmurHash3: a final avalanche so that every bit of the result
+// depends on every bit of *h*
+constexpr std::uint64_t fmix64(std::uint64_t h) noexcept
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+
+// Hash *len* bytes at *s*, mixed 8 at a time with fx_mix() after going through
+// *fold*, e.g. to ignore case. The last word is padded with zeros. Both the
+// low and the high bits of the result are usable.
+template <typename Fold>
+std::uint64_t fx_hash(const char* s, std::size_t len, Fold fold) noexcept
+{
+    std::uint64_t h = len;
+    std::size_t pos = 0;
+
+    for (; pos + 8 <= len; pos += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, s + pos, sizeof(word));
+        h = fx_mix(h, fold(word));
+    }
+
+    if (pos < len)
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, s + pos, len - pos);
+        h = fx_mix(h, fold(word));
+    }
+
+    return fmix64(h);
+}
+
+inline std::uint64_t fx_hash(const char* s, std::size_t len) noexcept
+{
+    return fx_hash(s, len, [](std::uint64_t word) { return word; });
+}
+
+}  // namespace detail
+}  // namespace cix
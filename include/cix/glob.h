@@ -0,0 +1,521 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+namespace string {
+
+enum glob_flags : unsigned
+{
+    glob_default = 0x00,
+
+    // ASCII letters match regardless of their case
+    glob_icase = 0x01,
+
+    // '/' and '\\' are separators, like in cix::path: they are matched only
+    // by a separator in the pattern, not by '*', '?' or a bracket expression,
+    // and a "**" component matches any number of path components
+    glob_path = 0x02,
+
+    // '\\' is an ordinary character instead of an escape character, e.g. for
+    // Windows paths with glob_path
+    glob_no_escape = 0x04,
+};
+
+CIX_IMPLEMENT_ENUM_BITOPS(glob_flags)
+
+
+namespace detail::glob
+{
+    typedef std::size_t size_type;
+    typedef std::uint64_t word_type;
+
+    static constexpr size_type npos = ~size_type(0);
+    static constexpr size_type word_bits = 64;
+
+    template <typename Char>
+    constexpr std::uint32_t unit(Char c) noexcept
+    {
+        return static_cast<std::uint32_t>(
+            static_cast<std::make_unsigned_t<Char>>(c));
+    }
+
+    constexpr std::uint32_t fold(std::uint32_t u) noexcept
+    {
+        return (u - 'A' < 26u) ? (u | 0x20u) : u;
+    }
+
+    constexpr bool is_sep(std::uint32_t u) noexcept
+    {
+        return u == '/' || u == '\\';
+    }
+
+    // case-insensitive hash of a literal, so that a single lookup finds both
+    // the case-sensitive and insensitive candidates
+    template <typename Char>
+    std::uint64_t hash(const Char* s, size_type len) noexcept
+    {
+        std::uint64_t h = len;
+
+        for (size_type idx = 0; idx < len; ++idx)
+            h = cix::detail::fx_mix(h, fold(unit(s[idx])));
+
+        return cix::detail::fmix64(h);
+    }
+
+
+    // The patterns of a set, compiled into matchers of decreasing speed:
+    // * literal patterns are looked up by hash
+    // * "*literal" patterns are looked up by the hash of the suffix of the
+    //   input of each distinct literal length
+    // * all other patterns are compiled into a single NFA of the positions of
+    //   their tokens, simulated over bit sets (Shift-And), so that a whole
+    //   set is run in one pass, in O(input length * positions / 64)
+    class program
+    {
+    public:
+        // *pattern* as code units
+        void add(const std::vector<std::uint32_t>& pattern, glob_flags flags);
+        void compile();
+
+        size_type patterns() const noexcept { return m_patterns; }
+
+        // index of the first pattern matching *input*, or npos
+        template <typename Char>
+        size_type find_first(const Char* input, size_type len) const;
+
+        // indexes of all the patterns matching *input*, in ascending order
+        template <typename Char>
+        void find_all(
+            const Char* input, size_type len, std::vector<size_type>& out) const;
+
+    private:
+        enum token_kind : std::uint8_t
+        {
+            tk_chars,     // one character, in or out of ranges
+            tk_star,      // any number of characters, but separators
+            tk_globstar,  // any number of characters
+            tk_accept,    // end of a pattern
+        };
+
+        struct token_t
+        {
+            token_kind kind;
+            bool negate;       // tk_chars: match characters out of ranges
+            bool no_sep;       // never match a separator (glob_path)
+            bool skip;         // tk_globstar: "**/" that may match nothing
+            std::uint32_t ranges_begin;
+            std::uint32_t ranges_end;
+            std::uint32_t pattern;
+        };
+
+        struct literal_t
+        {
+            std::uint32_t pattern;
+            std::uint32_t offset;  // in m_literal_units
+            std::uint32_t length;
+            bool icase;
+            bool no_sep_prefix;    // suffix: "*" cannot match a separator
+        };
+
+        typedef std::unordered_multimap<std::uint64_t, literal_t> literal_map;
+
+        // scratch bit sets, on the stack for small sets of patterns
+        class state_buffer
+        {
+        public:
+            word_type* get(size_type words)
+            {
+                if (words <= m_local.size())
+                    return m_local.data();
+
+                m_heap.reset(new word_type[words]);
+                return m_heap.get();
+            }
+
+        private:
+            std::array<word_type, 8> m_local;
+            std::unique_ptr<word_type[]> m_heap;
+        };
+
+        bool add_literal(
+            const std::vector<std::uint32_t>& pattern, glob_flags flags);
+        void add_tokens(
+            const std::vector<std::uint32_t>& pattern, glob_flags flags);
+
+        template <typename Char>
+        bool equals(const Char* input, const literal_t& literal) const noexcept
+        {
+            const auto* units = m_literal_units.data() + literal.offset;
+
+            for (size_type idx = 0; idx < literal.length; ++idx)
+            {
+                const auto u = unit(input[idx]);
+
+                if (u != units[idx] &&
+                    (!literal.icase || fold(u) != fold(units[idx])))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // call *func* with the index of each literal or suffix pattern that
+        // matches *input*
+        template <typename Char, typename Func>
+        void for_each_literal(
+            const Char* input, size_type len, Func&& func) const;
+
+        std::uint32_t class_of(std::uint32_t u) const noexcept
+        {
+            if (u < m_low_classes.size())
+                return m_low_classes[u];
+
+            return static_cast<std::uint32_t>(
+                std::upper_bound(m_bounds.begin(), m_bounds.end(), u) -
+                m_bounds.begin() - 1);
+        }
+
+        // run the NFA over *input* and return its final state, or nullptr if
+        // it died before the end of *input*
+        template <typename Char>
+        const word_type* run(
+            const Char* input, size_type len, state_buffer& buffer) const;
+
+        size_type first_accepted(const word_type* state) const noexcept;
+        void all_accepted(
+            const word_type* state, std::vector<size_type>& out) const;
+
+    private:
+        size_type m_patterns = 0;
+
+        // literal and suffix patterns
+        std::vector<std::uint32_t> m_literal_units;
+        literal_map m_exact;
+        literal_map m_suffixes;
+        std::vector<size_type> m_suffix_lengths;  // distinct, ascending
+
+        // tokens of the NFA, during construction only
+        std::vector<token_t> m_tokens;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> m_ranges;
+
+        // code units are mapped to the classes of units that no token tells
+        // apart, classes being delimited by m_bounds
+        std::array<std::uint32_t, 256> m_low_classes = {};
+        std::vector<std::uint32_t> m_bounds;
+
+        // bit sets of m_words words, one bit per position
+        size_type m_words = 0;
+        std::vector<word_type> m_consume;  // class * m_words + word
+        std::vector<word_type> m_loop;     // class * m_words + word
+        std::vector<word_type> m_skip;
+        std::vector<word_type> m_star;
+        std::vector<word_type> m_init;
+        std::vector<word_type> m_accept;
+        std::vector<std::uint32_t> m_bit_pattern;  // pattern of each position
+    };
+
+
+    template <typename Char, typename Func>
+    void program::for_each_literal(
+        const Char* input, size_type len, Func&& func) const
+    {
+        if (!m_exact.empty())
+        {
+            const auto range = m_exact.equal_range(hash(input, len));
+
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (it->second.length == len && this->equals(input, it->second))
+                    func(it->second.pattern);
+            }
+        }
+
+        if (m_suffix_lengths.empty())
+            return;
+
+        size_type first_sep = npos;
+
+        for (size_type idx = 0; idx < len; ++idx)
+        {
+            if (is_sep(unit(input[idx])))
+            {
+                first_sep = idx;
+                break;
+            }
+        }
+
+        for (const auto length : m_suffix_lengths)
+        {
+            if (length > len)
+                break;
+
+            const auto* suffix = input + len - length;
+            const auto range = m_suffixes.equal_range(hash(suffix, length));
+
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                const auto& literal = it->second;
+
+                if (literal.length == length &&
+                    (!literal.no_sep_prefix || first_sep >= len - length) &&
+                    this->equals(suffix, literal))
+                {
+                    func(literal.pattern);
+                }
+            }
+        }
+    }
+
+
+    template <typename Char>
+    const word_type* program::run(
+        const Char* input, size_type len, state_buffer& buffer) const
+    {
+        const auto words = m_words;
+        auto* state = buffer.get(words * 2);
+        auto* next = state + words;
+
+        std::copy(m_init.begin(), m_init.end(), state);
+
+        for (size_type idx = 0; idx < len; ++idx)
+        {
+            const auto cls = this->class_of(unit(input[idx]));
+            const auto* consume = m_consume.data() + cls * words;
+            const auto* loop = m_loop.data() + cls * words;
+            word_type carry_consume = 0;
+            word_type carry_skip = 0;
+            word_type carry_star = 0;
+            word_type alive = 0;
+
+            // Positions are entered by consuming a character at the previous
+            // one, then by skipping a "**/" just entered, while stars also
+            // stay active by consuming a character. Stars are finally left
+            // for free. Skips and stars are never chained by construction, so
+            // that a single pass is enough.
+            for (size_type w = 0; w < words; ++w)
+            {
+                // most patterns die early, leaving empty words behind
+                if (!(state[w] | carry_consume | carry_skip | carry_star))
+                {
+                    next[w] = 0;
+                    continue;
+                }
+
+                const auto consumed = state[w] & consume[w];
+                auto n = (consumed << 1) | carry_consume;
+                carry_consume = consumed >> (word_bits - 1);
+
+                const auto skipped = n & m_skip[w];
+                n |= (skipped << 2) | carry_skip;
+                carry_skip = skipped >> (word_bits - 2);
+
+                n |= state[w] & loop[w];
+
+                const auto starred = n & m_star[w];
+                n |= (starred << 1) | carry_star;
+                carry_star = starred >> (word_bits - 1);
+
+                next[w] = n;
+                alive |= n;
+            }
+
+            if (!alive)
+                return nullptr;
+
+            std::swap(state, next);
+        }
+
+        return state;
+    }
+
+
+    template <typename Char>
+    size_type program::find_first(const Char* input, size_type len) const
+    {
+        size_type first = npos;
+
+        this->for_each_literal(input, len, [&first](size_type pattern) {
+            first = std::min(first, pattern);
+        });
+
+        if (m_words)
+        {
+            state_buffer buffer;
+
+            if (const auto* state = this->run(input, len, buffer))
+                first = std::min(first, this->first_accepted(state));
+        }
+
+        return first;
+    }
+
+
+    template <typename Char>
+    void program::find_all(
+        const Char* input, size_type len, std::vector<size_type>& out) const
+    {
+        const auto initial_size = out.size();
+
+        this->for_each_literal(input, len, [&out](size_type pattern) {
+            out.push_back(pattern);
+        });
+
+        if (m_words)
+        {
+            state_buffer buffer;
+
+            if (const auto* state = this->run(input, len, buffer))
+                this->all_accepted(state, out);
+        }
+
+        std::sort(out.begin() + initial_size, out.end());
+    }
+}  // namespace detail::glob
+
+
+// A set of wildcard patterns compiled once, to tell which of them match a
+// string, e.g. to filter file names against a list of patterns.
+//
+// Supported syntax:
+// * "*" matches any sequence of characters, possibly empty
+// * "?" matches any single character
+// * "[abc]", "[a-z]" match a character of the set, "[!abc]" or "[^abc]" a
+//   character out of it; "]" is literal when first, "-" when first or last
+// * "**" is the same as "*", unless glob_path is set and it is a whole path
+//   component, in which case it matches any number of components, e.g.
+//   "a/**/b" matches "a/b", "a/x/b" and "a/x/y/b"
+// * "\\" escapes the next character, unless glob_no_escape is set
+//
+// Throws std::invalid_argument if a pattern is malformed, e.g. if it has an
+// unterminated bracket expression or ends with an escape character.
+//
+// Matching is per code unit, so that "?" and bracket expressions only apply
+// to ASCII characters in a UTF-8 string, and runs in linear time, without
+// backtracking. Matching methods are const and can be called concurrently.
+template <typename Char>
+class basic_glob_set
+{
+public:
+    typedef std::size_t size_type;
+    typedef Char char_type;
+    typedef std::basic_string_view<Char> view_type;
+
+    static constexpr size_type npos = detail::glob::npos;
+
+public:
+    // a set with no pattern, which never matches
+    basic_glob_set() = default;
+
+    basic_glob_set(
+        std::initializer_list<view_type> patterns,
+        glob_flags flags=glob_default)
+    {
+        for (const auto& pattern : patterns)
+            this->add(pattern, flags);
+
+        m_program.compile();
+    }
+
+    // *patterns* is a container of strings, like std::vector<std::string>
+    template <
+        typename Container,
+        typename std::enable_if_t<
+            is_container_of_strings_v<Container> &&
+            std::is_same_v<
+                Char,
+                typename is_container_of_strings<Container>::char_type>,
+            int> = 0>
+    explicit basic_glob_set(
+        const Container& patterns,
+        glob_flags flags=glob_default)
+    {
+        for (const auto& pattern : patterns)
+            this->add(view_type(pattern), flags);
+
+        m_program.compile();
+    }
+
+    size_type patterns() const noexcept { return m_program.patterns(); }
+
+    bool match_any(view_type input) const
+    {
+        return this->find_first(input) != npos;
+    }
+
+    // index of the first pattern that matches *input*, or npos
+    size_type find_first(view_type input) const
+    {
+        return m_program.find_first(input.data(), input.size());
+    }
+
+    // append the indexes of the patterns that match *input* to *out*, in
+    // ascending order
+    void find_all(view_type input, std::vector<size_type>& out) const
+    {
+        m_program.find_all(input.data(), input.size(), out);
+    }
+
+private:
+    void add(view_type pattern, glob_flags flags)
+    {
+        std::vector<std::uint32_t> units(pattern.size());
+
+        std::transform(
+            pattern.begin(), pattern.end(), units.begin(),
+            [](Char c) { return detail::glob::unit(c); });
+
+        m_program.add(units, flags);
+    }
+
+private:
+    detail::glob::program m_program;
+};
+
+
+// A single compiled wildcard pattern, see basic_glob_set for the syntax
+template <typename Char>
+class basic_glob
+{
+public:
+    typedef std::size_t size_type;
+    typedef Char char_type;
+    typedef std::basic_string_view<Char> view_type;
+
+public:
+    // a glob with no pattern, which never matches
+    basic_glob() = default;
+
+    explicit basic_glob(view_type pattern, glob_flags flags=glob_default)
+        : m_set{{ pattern }, flags}
+    { }
+
+    bool match(view_type input) const
+    {
+        return m_set.match_any(input);
+    }
+
+    bool operator()(view_type input) const
+    {
+        return this->match(input);
+    }
+
+private:
+    basic_glob_set<Char> m_set;
+};
+
+
+typedef basic_glob<char> glob;
+typedef basic_glob<wchar_t> wglob;
+
+typedef basic_glob_set<char> glob_set;
+typedef basic_glob_set<wchar_t> wglob_set;
+
+}  // namespace string
+}  // namespace cix
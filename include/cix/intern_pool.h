@@ -0,0 +1,145 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+namespace string {
+
+namespace detail::intern
+{
+    struct shard_t;  // see intern_pool.cpp
+}
+
+
+// A thread-safe pool of unique strings, aka symbol table, to hold a large
+// number of strings that are often repeated, like host or metric names, only
+// once in memory and to compare them as integers.
+//
+// Each distinct string is copied once to an arena and is given a *symbol*: a
+// 32-bit ID, dense and allocated in order from 0 so that it can index a plain
+// vector, and a view of the copy, which is null-terminated and remains valid
+// for the lifetime of the pool. Two strings interned to the same pool are
+// equal if and only if their IDs are.
+//
+// The pool is split into shards selected by the hash of the strings, each with
+// its own arena, hash index and reader-writer lock, so that concurrent lookups
+// of existing strings take a shared lock only and threads interning distinct
+// strings rarely contend. The mapping from ID to view never moves once written
+// and is read without lock.
+//
+// Strings are never removed, short of destroying the pool.
+class intern_pool
+{
+public:
+    typedef std::size_t size_type;
+    typedef std::uint32_t symbol_type;
+
+    static constexpr symbol_type npos = ~symbol_type(0);
+
+    // maximal number of symbols in a pool, i.e. IDs are in [0, npos)
+    static constexpr size_type max_symbols = npos;
+
+    // maximal number of shards, see the constructor
+    static constexpr size_type max_shards = 256;
+
+    struct symbol
+    {
+        symbol_type id;
+        std::string_view str;
+
+        // only meaningful for symbols of the same pool
+        bool operator==(const symbol& other) const noexcept { return id == other.id; }
+        bool operator!=(const symbol& other) const noexcept { return id != other.id; }
+        bool operator<(const symbol& other) const noexcept { return id < other.id; }
+    };
+
+    struct stats_type
+    {
+        size_type shards;
+        size_type symbols;
+
+        // sum of the lengths of the interned strings, i.e. what they would take
+        // as std::string's, without their headers and allocation overhead
+        size_type string_bytes;
+
+        // memory reserved by the arenas, including the null terminators and
+        // the free space at the end of the current blocks
+        size_type arena_bytes;
+
+        // memory taken by the hash indexes and the ID-to-view table
+        size_type index_bytes;
+
+        // number of symbols of the fullest and the emptiest shard, to check
+        // the balance of the shards
+        size_type max_shard_symbols;
+        size_type min_shard_symbols;
+    };
+
+public:
+    CIX_NONCOPYABLE(intern_pool)
+    CIX_NONMOVABLE(intern_pool)
+
+    // *shards* is rounded up to the next power of two, and capped to
+    // max_shards. 0 means twice std::thread::hardware_concurrency(). 1 is best
+    // for a pool used by a single thread.
+    explicit intern_pool(size_type shards = 0);
+
+    ~intern_pool();
+
+    size_type shards() const noexcept { return m_shard_mask + 1; }
+
+    // number of symbols, approximate if called while other threads are
+    // interning strings
+    size_type size() const noexcept;
+
+    bool empty() const noexcept { return this->size() == 0; }
+
+    // return the symbol of *str*, after adding it to the pool if needed.
+    // Throws std::length_error if the pool is full.
+    symbol intern(std::string_view str);
+
+    // the ID of *str* if it is in the pool, npos otherwise
+    symbol_type find(std::string_view str) const;
+
+    bool contains(std::string_view str) const { return this->find(str) != npos; }
+
+    // the string of symbol *id*, which must have been returned by intern() or
+    // find()
+    std::string_view view(symbol_type id) const noexcept;
+
+    std::string_view operator[](symbol_type id) const noexcept { return this->view(id); }
+
+    // walk all the shards, holding each lock in turn
+    stats_type stats() const;
+
+private:
+    // the ID-to-view table is made of segments that are allocated as needed
+    // and never moved, the first one holds the first 2^first_segment_bits IDs,
+    // then each segment is as big as all the previous ones
+    static constexpr unsigned first_segment_bits = 10;
+    static constexpr unsigned segment_count = 33 - first_segment_bits;
+
+    static unsigned segment_of(symbol_type id) noexcept;
+    static size_type segment_base(unsigned segment) noexcept;
+    static size_type segment_size(unsigned segment) noexcept;
+
+    symbol_type find_in(
+        const detail::intern::shard_t& shard,
+        std::string_view str, std::uint32_t hash32) const noexcept;
+
+    std::string_view* segment_for_write(unsigned segment);
+    symbol_type allocate_id(std::string_view str);
+
+private:
+    std::unique_ptr<detail::intern::shard_t[]> m_shards;
+    size_type m_shard_mask;
+    std::atomic<std::uint64_t> m_next_id;
+    std::array<std::atomic<std::string_view*>, segment_count> m_segments;
+};
+
+}  // namespace string
+}  // namespace cix
@@ -0,0 +1,47 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+namespace lz {
+
+// A fast, self-contained LZ77 block compressor from the LZ4 family.
+//
+// Output follows the LZ4 *block* format (no frame, no checksum): a sequence of
+// tokens made of a literal run and a back-reference into a 64 KiB window.
+// Favors speed over compression ratio. See `cix::compressed_memstream` for a
+// framed, checksummed use of this codec.
+
+// returned by decompress() on malformed input
+static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+// worst-case size of the output of compress() for an input of *size* bytes
+constexpr std::size_t compress_bound(std::size_t size) noexcept
+{
+    return size + (size / 255) + 16;
+}
+
+// Compress *src_size* bytes from *src* to *dest*.
+//
+// *dest_capacity* must be at least `compress_bound(src_size)`, in which case
+// compression cannot fail. Returns the number of bytes written to *dest*, or
+// zero if *dest_capacity* is too small.
+std::size_t compress(
+    const void* src, std::size_t src_size,
+    void* dest, std::size_t dest_capacity) noexcept;
+
+// Decompress *src_size* bytes from *src* to *dest*.
+//
+// Never reads or writes out of the given boundaries, even on malformed or
+// malicious input. Returns the number of bytes written to *dest*, or `npos` if
+// *src* is malformed or if *dest_capacity* is too small.
+std::size_t decompress(
+    const void* src, std::size_t src_size,
+    void* dest, std::size_t dest_capacity) noexcept;
+
+}  // namespace lz
+}  // namespace cix
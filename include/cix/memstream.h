@@ -8,6 +8,8 @@
 
 namespace cix {
 
+class memstream_slice;
+
 class memstream
 {
 public:
@@ -32,6 +34,11 @@ protected:
 public:
     explicit memstream(size_type grow_size=default_grow_size);
     memstream(const_pointer data, size_type size);
+    memstream(const memstream& other);
+    memstream(memstream&& other) noexcept;
+
+    memstream& operator=(const memstream& other);
+    memstream& operator=(memstream&& other) noexcept;
 
     memstream& open_read(const_pointer data, size_type size);  // enable read-only mode
     bool read_only() const;
@@ -69,6 +76,14 @@ public:
         size_type expected_size,
         bool advance_rpos_on_match);
 
+    // zero-copy read
+    // a slice shares the buffer of the stream and keeps it alive, even after
+    // the stream has been cleared or destroyed
+    // CAUTION: in read-only mode (open_read), memory is not owned by the
+    // stream and a slice gets its own copy of the data
+    memstream_slice slice(pos_type pos, size_type size=npos) const;
+    memstream_slice read_slice(size_type size);
+
     // single byte i/o
     memstream& write(const std::uint8_t value);
     memstream& read(std::uint8_t& value);
@@ -92,6 +107,7 @@ public:
     memstream& finalize_write(size_type written);
 
 protected:
+    void detach(size_type new_size);
     void grow(size_type required_extra_size);
     bool ensure(size_type read_size);
     memstream& seek_impl(pos_type& cursor, pos_type position);
@@ -105,7 +121,60 @@ protected:
     pos_type m_wpos;
 
     size_type m_view_size;
-    container m_container;
+
+    // shared with memstream_slice objects, if any
+    // copied-on-write when bytes visible to a slice are about to be modified,
+    // or when the buffer needs to be reallocated
+    std::shared_ptr<container> m_container;
+};
+
+
+
+// A read-only, ref-counted view to a memstream buffer, as returned by
+// `memstream::slice()`.
+//
+// Copying a slice is cheap and does not copy data. A slice can be handed to
+// another thread as long as it is not modified concurrently.
+class memstream_slice
+{
+public:
+    typedef memstream::value_type value_type;
+    typedef memstream::const_pointer const_pointer;
+    typedef memstream::const_reference const_reference;
+    typedef memstream::size_type size_type;
+    typedef memstream::pos_type pos_type;
+
+    static constexpr size_type npos = memstream::npos;
+
+public:
+    memstream_slice() noexcept;
+    ~memstream_slice() = default;
+
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    const_pointer data() const noexcept;
+
+    const_pointer begin() const noexcept;
+    const_pointer end() const noexcept;
+
+    const_reference operator[](pos_type pos) const;
+
+    // a sub-slice that shares the same buffer
+    memstream_slice slice(pos_type pos, size_type size=npos) const;
+
+    // release buffer
+    void reset() noexcept;
+
+private:
+    friend class memstream;
+
+    memstream_slice(
+        std::shared_ptr<const value_type> data,
+        size_type size) noexcept;
+
+private:
+    std::shared_ptr<const value_type> m_data;  // aliases the owner's buffer
+    size_type m_size;
 };
 
 }  // namespace cix
@@ -0,0 +1,108 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+
+// A byte ring buffer whose memory is mapped twice, back to back, in virtual
+// memory.
+//
+// Since byte `capacity() + n` is an alias of byte `n`, both the readable and
+// the writable regions are always contiguous, regardless of where the cursors
+// are. They can be passed as-is to read(2), write(2), memcpy or a parser,
+// without having to handle the wrap-around split.
+//
+// Typical usage:
+//
+//   auto n = ::read(fd, ring.write_ptr(), ring.writable());
+//   ring.commit(n);
+//   auto consumed = parse(ring.read_ptr(), ring.readable());
+//   ring.consume(consumed);
+//
+// The capacity is rounded up to the allocation granularity of the platform,
+// i.e. page size on POSIX systems and 64 KiB on Windows.
+//
+// Backed by memfd_create() on Linux, by an unlinked shm_open() object on other
+// POSIX systems, and by a pagefile-backed section on Windows.
+//
+// CAUTION: not thread-safe
+class mirrored_ring
+{
+public:
+    typedef std::size_t size_type;
+    typedef std::uint8_t value_type;
+    typedef value_type* pointer;
+    typedef const value_type* const_pointer;
+
+public:
+    CIX_NONCOPYABLE(mirrored_ring)
+
+    // empty, unallocated ring
+    mirrored_ring() noexcept;
+
+    // capacity is at least *min_capacity* bytes
+    explicit mirrored_ring(size_type min_capacity);
+
+    mirrored_ring(mirrored_ring&& other) noexcept;
+    mirrored_ring& operator=(mirrored_ring&& other) noexcept;
+
+    ~mirrored_ring();
+
+    // allocation granularity of the platform
+    static size_type granularity();
+
+    // release current mapping, if any, and map a new one
+    // CAUTION: data is discarded
+    void reset(size_type min_capacity);
+
+    // release current mapping, if any
+    void release() noexcept;
+
+    bool valid() const noexcept { return m_base != nullptr; }
+    size_type capacity() const noexcept { return m_capacity; }
+    size_type size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+    bool full() const noexcept { return m_size == m_capacity; }
+
+    // drop all data, capacity remains unchanged
+    void clear() noexcept;
+
+
+    // consumer side
+
+    // readable region, size() bytes long
+    const_pointer read_ptr() const noexcept { return m_base + m_head; }
+    pointer read_ptr() noexcept { return m_base + m_head; }
+    size_type readable() const noexcept { return m_size; }
+
+    // discard the first *count* readable bytes
+    void consume(size_type count) noexcept;
+
+    // copy and consume up to *size* bytes, return the number of bytes read
+    size_type read(void* dest, size_type size) noexcept;
+
+
+    // producer side
+
+    // writable region, writable() bytes long
+    pointer write_ptr() noexcept { return m_base + m_head + m_size; }
+    size_type writable() const noexcept { return m_capacity - m_size; }
+
+    // make the first *count* writable bytes readable
+    void commit(size_type count) noexcept;
+
+    // copy and commit up to *size* bytes, return the number of bytes written
+    size_type write(const void* src, size_type size) noexcept;
+
+private:
+    pointer m_base;  // capacity() * 2 bytes of address space
+    size_type m_capacity;
+    size_type m_head;
+    size_type m_size;
+};
+
+}  // namespace cix
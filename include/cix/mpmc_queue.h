@@ -0,0 +1,409 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+
+// A bounded, lock-free, multi-producer/multi-consumer FIFO queue.
+//
+// Implementation of Dmitry Vyukov's bounded MPMC queue: each slot of a
+// power-of-two array carries a sequence number that tells producers and
+// consumers whether the slot is ready for them, so that a push or a pop costs
+// a single CAS on the shared cursor in the uncontended case.
+// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+//
+// Three flavors of each operation are offered:
+// * try_push() / try_pop() never wait
+// * push_spin() / pop_spin() busy-wait, for low-latency dedicated threads
+// * push() / pop() and their timed variants spin briefly, then sleep on a
+//   condition variable
+//
+// The lock-free path never takes the mutex. It is only locked to sleep, and by
+// the other side to wake sleepers up, if any. Checking for sleepers costs no
+// fence since cells are published with a seq_cst store.
+//
+// CAUTION: push methods taking an rvalue only move from *item* on success, so
+// it can be retried safely.
+template <typename T>
+class mpmc_queue
+{
+public:
+    typedef std::size_t size_type;
+    typedef T value_type;
+    typedef value_type& reference;
+    typedef const value_type& const_reference;
+
+    // number of attempts of the blocking methods, before going to sleep
+    static constexpr unsigned spin_count = 64;
+
+    static_assert(std::is_default_constructible_v<T>);
+
+public:
+    CIX_NONCOPYABLE(mpmc_queue)
+    CIX_NONMOVABLE(mpmc_queue)
+
+    // *capacity* is rounded up to the next power of two
+    explicit mpmc_queue(size_type capacity)
+        : m_cells{}
+        , m_mask{0}
+        , m_enqueue_pos{0}
+        , m_dequeue_pos{0}
+        , m_push_waiters{0}
+        , m_pop_waiters{0}
+    {
+        if (capacity > (std::numeric_limits<size_type>::max() >> 1))
+            CIX_THROW_LENGTH("mpmc_queue capacity too big ({})", capacity);
+
+        size_type pow2 = 2;
+        while (pow2 < capacity)
+            pow2 <<= 1;
+
+        m_cells.reset(new cell_t[pow2]);
+        m_mask = pow2 - 1;
+
+        for (size_type idx = 0; idx < pow2; ++idx)
+            m_cells[idx].sequence.store(idx, std::memory_order_relaxed);
+    }
+
+    ~mpmc_queue() = default;
+
+    size_type capacity() const noexcept
+    {
+        return m_mask + 1;
+    }
+
+    // approximate if called concurrently with push or pop operations
+    size_type size() const noexcept
+    {
+        const auto head = m_dequeue_pos.load(std::memory_order_acquire);
+        const auto tail = m_enqueue_pos.load(std::memory_order_acquire);
+        return (tail >= head) ? std::min(tail - head, this->capacity()) : 0;
+    }
+
+    // approximate if called concurrently with push or pop operations
+    bool empty() const noexcept
+    {
+        return this->size() == 0;
+    }
+
+
+    // non-waiting
+
+    bool try_push(const_reference item)
+    {
+        return this->push_impl(item);
+    }
+
+    bool try_push(value_type&& item)
+    {
+        return this->push_impl(std::move(item));
+    }
+
+    bool try_pop(reference item)
+    {
+        return this->pop_impl(item);
+    }
+
+
+    // busy-waiting
+
+    void push_spin(const_reference item)
+    {
+        while (!this->push_impl(item))
+            cpu_relax();
+    }
+
+    void push_spin(value_type&& item)
+    {
+        while (!this->push_impl(std::move(item)))
+            cpu_relax();
+    }
+
+    void pop_spin(reference item)
+    {
+        while (!this->pop_impl(item))
+            cpu_relax();
+    }
+
+
+    // blocking
+
+    void push(const_reference item)
+    {
+        this->wait_push(item, no_deadline);
+    }
+
+    void push(value_type&& item)
+    {
+        this->wait_push(std::move(item), no_deadline);
+    }
+
+    void pop(reference item)
+    {
+        this->wait_pop(item, no_deadline);
+    }
+
+
+    // timed
+
+    template <typename Rep, typename Period>
+    bool try_push_for(
+        const_reference item,
+        const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return this->wait_push(item, deadline_from(timeout));
+    }
+
+    template <typename Rep, typename Period>
+    bool try_push_for(
+        value_type&& item,
+        const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return this->wait_push(std::move(item), deadline_from(timeout));
+    }
+
+    template <typename Rep, typename Period>
+    bool try_pop_for(
+        reference item,
+        const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return this->wait_pop(item, deadline_from(timeout));
+    }
+
+
+private:
+    typedef std::chrono::steady_clock clock_type;
+    typedef clock_type::time_point deadline_type;
+
+    static constexpr deadline_type no_deadline = deadline_type::max();
+
+    struct cell_t
+    {
+        std::atomic<size_type> sequence;
+        value_type data;
+    };
+
+    template <typename Rep, typename Period>
+    static deadline_type deadline_from(
+        const std::chrono::duration<Rep, Period>& timeout)
+    {
+        typedef std::chrono::duration<double> fsec;
+
+        const auto now = clock_type::now();
+        const auto max_timeout = no_deadline - now;
+
+        if (timeout <= timeout.zero())
+            return now;
+
+        // compare as floating point seconds since converting *timeout* to the
+        // clock's (finer) period may overflow, e.g. with duration::max()
+        if (fsec(timeout) >= fsec(max_timeout))
+            return no_deadline;
+
+        return now + std::chrono::duration_cast<clock_type::duration>(timeout);
+    }
+
+    template <typename U>
+    bool push_impl(U&& item)
+    {
+        if (!this->enqueue(std::forward<U>(item)))
+            return false;
+
+        this->wake(m_pop_waiters, m_not_empty);
+        return true;
+    }
+
+    bool pop_impl(reference item)
+    {
+        if (!this->dequeue(item))
+            return false;
+
+        this->wake(m_push_waiters, m_not_full);
+        return true;
+    }
+
+    template <typename U>
+    bool enqueue(U&& item)
+    {
+        cell_t* cell;
+        auto pos = m_enqueue_pos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            cell = &m_cells[pos & m_mask];
+
+            const auto seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff =
+                static_cast<std::intptr_t>(seq) -
+                static_cast<std::intptr_t>(pos);
+
+            if (diff == 0)
+            {
+                if (m_enqueue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;  // full
+            }
+            else
+            {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        // seq_cst so that wake() needs no fence, see wait()
+        cell->data = std::forward<U>(item);
+        cell->sequence.store(pos + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    bool dequeue(reference item)
+    {
+        cell_t* cell;
+        auto pos = m_dequeue_pos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            cell = &m_cells[pos & m_mask];
+
+            const auto seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff =
+                static_cast<std::intptr_t>(seq) -
+                static_cast<std::intptr_t>(pos + 1);
+
+            if (diff == 0)
+            {
+                if (m_dequeue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;  // empty
+            }
+            else
+            {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        // seq_cst so that wake() needs no fence, see wait()
+        item = std::move(cell->data);
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    template <typename U>
+    bool wait_push(U&& item, deadline_type deadline)
+    {
+        // CAUTION: enqueue() only consumes *item* on success
+        const bool pushed = this->wait(
+            m_push_waiters, m_not_full, deadline,
+            [&]() { return this->enqueue(std::forward<U>(item)); });
+
+        if (pushed)
+            this->wake(m_pop_waiters, m_not_empty);
+
+        return pushed;
+    }
+
+    bool wait_pop(reference item, deadline_type deadline)
+    {
+        const bool popped = this->wait(
+            m_pop_waiters, m_not_empty, deadline,
+            [&]() { return this->dequeue(item); });
+
+        if (popped)
+            this->wake(m_push_waiters, m_not_full);
+
+        return popped;
+    }
+
+    // CAUTION: *attempt* must not call wake() since m_mutex may be held
+
+    template <typename Attempt>
+    bool wait(
+        std::atomic<size_type>& waiters,
+        std::condition_variable& cv,
+        deadline_type deadline,
+        Attempt attempt)
+    {
+        for (unsigned idx = 0; idx < spin_count; ++idx)
+        {
+            if (attempt())
+                return true;
+            cpu_relax();
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        bool result = false;
+
+        // the other side publishes a cell with a seq_cst store, then checks
+        // *waiters* with a seq_cst load, so that either it sees us waiting, or
+        // the attempts below see its update
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        for (;;)
+        {
+            if (attempt())
+            {
+                result = true;
+                break;
+            }
+
+            if (deadline == no_deadline)
+            {
+                cv.wait(lock);
+            }
+            else if (cv.wait_until(lock, deadline) == std::cv_status::timeout)
+            {
+                result = attempt();
+                break;
+            }
+        }
+
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    // CAUTION: must follow the seq_cst store of a cell's sequence, see wait()
+    void wake(std::atomic<size_type>& waiters, std::condition_variable& cv)
+    {
+        // a plain load on x86, unlike a full fence
+        if (waiters.load(std::memory_order_seq_cst) > 0)
+        {
+            // lock so that a waiter cannot miss the notification between its
+            // last attempt and its call to wait()
+            { std::lock_guard<std::mutex> lock(m_mutex); }
+            cv.notify_one();
+        }
+    }
+
+
+private:
+    std::unique_ptr<cell_t[]> m_cells;
+    size_type m_mask;
+
+    alignas(cache_line_size) std::atomic<size_type> m_enqueue_pos;
+    alignas(cache_line_size) std::atomic<size_type> m_dequeue_pos;
+
+    // slow path
+    alignas(cache_line_size) std::atomic<size_type> m_push_waiters;
+    std::atomic<size_type> m_pop_waiters;
+    std::mutex m_mutex;
+    std::condition_variable m_not_full;
+    std::condition_variable m_not_empty;
+};
+
+}  // namespace cix
@@ -0,0 +1,114 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+namespace string {
+
+// Replace any number of patterns in a single pass over the input, e.g. to
+// redact a list of tokens from messages.
+//
+// Patterns are compiled once into an Aho-Corasick automaton whose failure
+// links are resolved into a DFA, so that each input byte costs exactly one
+// table lookup. Input bytes are first mapped to the classes of bytes that
+// actually appear in the patterns to keep the table small.
+//
+// When matches overlap, the leftmost one wins, then the longest one, and
+// scanning resumes right after it (i.e. like a regex alternation of the
+// patterns sorted by decreasing length).
+//
+// Matching is byte-wise, which is also correct for UTF-8 strings as long as
+// patterns are valid UTF-8.
+//
+// If the same pattern is given more than once, its last replacement is used.
+class multi_replacer
+{
+public:
+    typedef std::size_t size_type;
+    typedef std::pair<std::string_view, std::string_view> pair_type;
+
+public:
+    // a replacer with no pattern, replace() returns a copy of its input
+    multi_replacer() = default;
+
+    multi_replacer(std::initializer_list<pair_type> patterns);
+
+    // *patterns* is a container of pairs of strings (pattern, replacement),
+    // like std::map<std::string, std::string>
+    template <
+        typename Container,
+        typename std::enable_if_t<
+            std::is_constructible_v<
+                std::string_view,
+                typename Container::value_type::first_type> &&
+            std::is_constructible_v<
+                std::string_view,
+                typename Container::value_type::second_type>, int> = 0>
+    explicit multi_replacer(const Container& patterns)
+    {
+        for (const auto& pair : patterns)
+        {
+            this->add(
+                std::string_view(pair.first),
+                std::string_view(pair.second));
+        }
+
+        this->compile();
+    }
+
+    size_type patterns() const noexcept { return m_entries.size(); }
+
+    // number of states of the automaton
+    size_type states() const noexcept { return m_out.size(); }
+
+    // true if *input* contains at least one of the patterns
+    bool contains_any(std::string_view input) const noexcept;
+
+    // append the result of the replacements to *out*, so that a buffer can be
+    // reused over several calls
+    void replace_to(std::string_view input, std::string& out) const;
+
+    std::string replace(std::string_view input) const;
+
+private:
+    static constexpr std::uint32_t no_match = ~std::uint32_t(0);
+
+    struct entry_t
+    {
+        size_type from_size;
+        size_type to_offset;
+        size_type to_size;
+    };
+
+    void add(std::string_view from, std::string_view to);
+    void compile();
+
+    std::uint32_t next(std::uint32_t state, char c) const noexcept
+    {
+        return m_delta[
+            state * m_classes_count +
+            m_classes[static_cast<std::uint8_t>(c)]];
+    }
+
+private:
+    // pattern and replacement strings, during construction only
+    std::vector<std::pair<std::string, std::string>> m_pending;
+
+    std::vector<entry_t> m_entries;
+    std::string m_replacements;  // all replacements, concatenated
+
+    std::array<std::uint8_t, 256> m_classes = {};
+    size_type m_classes_count = 1;
+
+    // per state data
+    std::vector<std::uint32_t> m_delta;  // state * m_classes_count + class
+    std::vector<std::uint32_t> m_depth;  // length of the matched prefix
+    std::vector<std::uint32_t> m_out;    // longest pattern ending here
+};
+
+}  // namespace string
+}  // namespace cix
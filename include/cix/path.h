@@ -57,6 +57,15 @@ static constexpr auto unix_sep_str = string::to_string_view(unix_sep_arr<Char>);
 template <typename Char>
 static constexpr auto win_sep_str = string::to_string_view(win_sep_arr<Char>);
 
+// both separators, to search strings of 1-byte characters
+static constexpr char_set all_seps_set{std::string_view("/\\", 2)};
+
+
+
+namespace detail
+{
+    template <typename Char> class component_range;
+}
 
 
 template <typename Char>
@@ -150,6 +159,59 @@ std::enable_if_t<
 rtrim_sep(const String& path) noexcept;
 
 
+// components
+//
+// Lazy range over the elements of *path*, without allocation: its root first,
+// if any, as it appears in *path* (e.g. "/", "C:", "C:/", or "\\server\share\"
+// on Windows), then the names between separators. Repeated and trailing
+// separators are skipped, "." and ".." are yielded as-is.
+//
+// CAUTION: the range refers to the data of *path*, which must outlive it.
+template <
+    typename String,
+    typename Char = string::char_t<String>>
+std::enable_if_t<
+    string::is_string_viewable_v<String>,
+    detail::component_range<Char>>
+components(const String& path) noexcept;
+
+
+// normalize_to
+//
+// Append the lexically normalized form of *path* to *out*, a container of
+// characters like std::basic_string:
+// * separators are collapsed and converted to native_sep, trailing ones are
+//   removed
+// * "." elements are removed
+// * a ".." element removes the element before it, or is removed if it follows
+//   the root of an absolute path, or is kept otherwise (e.g. "../a")
+// * "." is output if nothing remains of a non-empty *path*
+//
+// The file system is not accessed, so symbolic links are not resolved.
+template <
+    typename String,
+    typename OutContainer,
+    typename Char = string::char_t<String>>
+std::enable_if_t<
+    string::is_string_viewable_v<String> &&
+    std::is_class_v<OutContainer>,
+    OutContainer&>
+normalize_to(const String& path, OutContainer& out);
+
+// normalize_to (fixed buffer)
+//
+// Same as above, except that the result is written to *out*, which must have
+// room for as many characters as *path*. The result is never longer than
+// *path*, and it is not null-terminated. Return its length.
+template <
+    typename String,
+    typename Char = string::char_t<String>>
+std::enable_if_t<
+    string::is_string_viewable_v<String>,
+    std::size_t>
+normalize_to(const String& path, Char* out) noexcept;
+
+
 // join (variadic)
 template <
     typename String,
@@ -173,6 +235,34 @@ join(
     const Container& elements) noexcept;
 
 
+// join_to (variadic)
+// append the result of `cix::path::join` to *out*, e.g. a reused std::string
+template <
+    typename OutContainer,
+    typename String,
+    typename... Args,
+    typename Char = string::char_t<String>>
+std::enable_if_t<
+    string::is_string_viewable_v<String>,
+    OutContainer&>
+join_to(
+    OutContainer& out,
+    const String& head,
+    Args&&... args);
+
+// join_to (from a container of strings)
+template <
+    typename OutContainer,
+    typename Container,
+    typename Char = string::is_container_of_strings<Container>::char_type>
+std::enable_if_t<
+    string::is_container_of_strings_v<Container>,
+    OutContainer&>
+join_to(
+    OutContainer& out,
+    const Container& elements);
+
+
 // join_with (variadic)
 template <
     typename String,
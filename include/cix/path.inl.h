@@ -5,6 +5,287 @@
 namespace cix {
 namespace path {
 
+namespace detail
+{
+    // offset of the last separator in *view*, npos if none
+    template <typename Char>
+    inline std::size_t find_last_sep(std::basic_string_view<Char> view) noexcept
+    {
+        if constexpr (sizeof(Char) == 1)
+        {
+            return all_seps_set.find_last(view);
+        }
+        else
+        {
+            const auto rit = std::find_if(view.rbegin(), view.rend(), is_sep<Char>);
+            if (rit == view.rend())
+                return std::basic_string_view<Char>::npos;
+
+            return std::distance(view.begin(), rit.base()) - 1;
+        }
+    }
+
+    template <typename Char>
+    inline std::basic_string_view<Char>
+    ltrim_sep(std::basic_string_view<Char> view) noexcept
+    {
+        if constexpr (sizeof(Char) == 1)
+            return string::ltrim_if(view, all_seps_set);
+        else
+            return string::ltrim_if(view, is_sep<Char>);
+    }
+
+    template <typename Char>
+    inline std::basic_string_view<Char>
+    rtrim_sep(std::basic_string_view<Char> view) noexcept
+    {
+        if constexpr (sizeof(Char) == 1)
+            return string::rtrim_if(view, all_seps_set);
+        else
+            return string::rtrim_if(view, is_sep<Char>);
+    }
+
+    // offset of the first separator in *view* from *pos*, npos if none
+    template <typename Char>
+    inline std::size_t
+    find_first_sep(std::basic_string_view<Char> view, std::size_t pos) noexcept
+    {
+        if constexpr (sizeof(Char) == 1)
+        {
+            return all_seps_set.find_first(view, pos);
+        }
+        else
+        {
+            for (; pos < view.size(); ++pos)
+            {
+                if (is_sep(view[pos]))
+                    return pos;
+            }
+
+            return std::basic_string_view<Char>::npos;
+        }
+    }
+
+    // length of the root of *path*, 0 if none: a drive letter and/or a
+    // separator, or \\server\share\ on Windows
+    template <typename Char>
+    constexpr std::size_t root_length(std::basic_string_view<Char> path) noexcept
+    {
+        std::size_t len = 0;
+
+        if (path.size() >= 2 && path[1] == Char(':') && is_drive_letter(path[0]))
+        {
+            len = 2;
+        }
+    #ifdef _WIN32
+        else if (
+            path.size() > 2 &&
+            is_sep(path[0]) && is_sep(path[1]) && !is_sep(path[2]))
+        {
+            // server, then share, each with its trailing separator, if any
+            len = 2;
+
+            for (int part = 0; part < 2 && len < path.size(); ++part)
+            {
+                while (len < path.size() && !is_sep(path[len]))
+                    ++len;
+
+                if (len < path.size())
+                    ++len;
+            }
+
+            return len;
+        }
+    #endif
+
+        if (len < path.size() && is_sep(path[len]))
+            ++len;
+
+        return len;
+    }
+
+    template <typename Char>
+    class component_range
+    {
+    public:
+        typedef std::basic_string_view<Char> view_type;
+
+        class iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef view_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const view_type* pointer;
+            typedef const view_type& reference;
+
+        public:
+            iterator() noexcept = default;
+
+            explicit iterator(view_type path) noexcept
+                : m_path{path}
+            {
+                const auto root_len = root_length(path);
+
+                if (root_len > 0)
+                {
+                    m_elem = path.substr(0, root_len);
+                    m_offset = 0;
+                    m_next = root_len;
+                }
+                else
+                {
+                    this->fetch(0);
+                }
+            }
+
+            reference operator*() const noexcept { return m_elem; }
+            pointer operator->() const noexcept { return &m_elem; }
+
+            iterator& operator++() noexcept
+            {
+                this->fetch(m_next);
+                return *this;
+            }
+
+            iterator operator++(int) noexcept
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            // iterators of the same range only
+            friend bool operator==(
+                const iterator& lhs, const iterator& rhs) noexcept
+            {
+                return lhs.m_offset == rhs.m_offset;
+            }
+
+            friend bool operator!=(
+                const iterator& lhs, const iterator& rhs) noexcept
+            {
+                return !(lhs == rhs);
+            }
+
+        private:
+            void fetch(std::size_t pos) noexcept
+            {
+                while (pos < m_path.size() && is_sep(m_path[pos]))
+                    ++pos;
+
+                if (pos >= m_path.size())
+                {
+                    *this = iterator{};
+                    return;
+                }
+
+                auto end = find_first_sep(m_path, pos);
+                if (end == view_type::npos)
+                    end = m_path.size();
+
+                m_elem = m_path.substr(pos, end - pos);
+                m_offset = pos;
+                m_next = end;
+            }
+
+        private:
+            view_type m_path;
+            view_type m_elem;
+            std::size_t m_offset = view_type::npos;  // npos for end()
+            std::size_t m_next = view_type::npos;
+        };
+
+        typedef iterator const_iterator;
+
+    public:
+        explicit component_range(view_type path) noexcept
+            : m_path{path}
+            { }
+
+        iterator begin() const noexcept { return iterator{m_path}; }
+        iterator end() const noexcept { return iterator{}; }
+
+        bool empty() const noexcept { return this->begin() == this->end(); }
+
+    private:
+        view_type m_path;
+    };
+
+    // see normalize_to(), *dest* must have room for path.size() characters
+    template <typename Char>
+    std::size_t normalize(std::basic_string_view<Char> path, Char* dest) noexcept
+    {
+        constexpr auto sep = native_sep<Char>;
+        constexpr auto dot = Char('.');
+
+        const auto root_len = root_length(path);
+        const bool absolute =
+            root_len > 0 && (is_sep(path[0]) || is_sep(path[root_len - 1]));
+        std::size_t len = 0;
+
+        for (; len < root_len; ++len)
+            dest[len] = is_sep(path[len]) ? sep : path[len];
+
+        // the root and the leading ".." elements of a relative path cannot be
+        // removed
+        auto fixed_len = root_len;
+
+        for (auto pos = root_len; pos < path.size(); )
+        {
+            if (is_sep(path[pos]))
+            {
+                ++pos;
+                continue;
+            }
+
+            auto end = find_first_sep(path, pos);
+            if (end == path.npos)
+                end = path.size();
+
+            const auto elem = path.substr(pos, end - pos);
+            const bool dotdot = elem.size() == 2 && elem[0] == dot && elem[1] == dot;
+
+            pos = end;
+
+            if (elem.size() == 1 && elem[0] == dot)
+                continue;
+
+            if (dotdot && len > fixed_len)
+            {
+                // remove the last element, then its separator
+                while (len > fixed_len && dest[len - 1] != sep)
+                    --len;
+
+                if (len > root_len)
+                    --len;
+
+                continue;
+            }
+
+            if (dotdot && absolute)
+                continue;
+
+            // each element but the first one is preceded by at least one
+            // separator in *path*, so that *dest* never outgrows it
+            if (len > root_len)
+                dest[len++] = sep;
+
+            std::copy(elem.begin(), elem.end(), dest + len);
+            len += elem.size();
+
+            if (dotdot)
+                fixed_len = len;
+        }
+
+        if (len == 0 && !path.empty())
+            dest[len++] = dot;
+
+        return len;
+    }
+}  // namespace detail
+
+
 template <typename Char>
 inline constexpr bool is_sep(Char c) noexcept
 {
@@ -144,17 +425,17 @@ basename(const String& path) noexcept
         return view;
 
     // trim trailing separators
-    view = string::rtrim_if(view, is_sep<Char>);
+    view = detail::rtrim_sep(view);
     if (view.empty())
         return sep;  // there was only separator(s) in path
 
     // search for the last separator in the string
-    auto rit = std::find_if(view.rbegin(), view.rend(), is_sep<Char>);
-    if (rit == view.rend())
+    const auto pos = detail::find_last_sep(view);
+    if (pos == view.npos)
         return view;  // no separator
 
     // strip prefix up to the last found separator
-    view.remove_prefix(std::distance(view.begin(), rit.base()));
+    view.remove_prefix(pos + 1);
     return view;
 }
 
@@ -188,20 +469,20 @@ dirname(const String& path) noexcept
         return dot;
 
     // trim trailing separators
-    view = string::rtrim_if(view, is_sep<Char>);
+    view = detail::rtrim_sep(view);
     if (view.empty())
         return sep;  // there was only separator(s) in path
 
     // search for the last separator in the string
-    auto rit = std::find_if(view.rbegin(), view.rend(), is_sep<Char>);
-    if (rit == view.rend())
+    const auto pos = detail::find_last_sep(view);
+    if (pos == view.npos)
         return dot;  // no separator
 
     // strip basename
-    view.remove_suffix(std::distance(rit.base(), view.end()));
+    view.remove_suffix(view.size() - pos - 1);
 
     // trim trailing separators
-    view = string::rtrim_if(view, is_sep<Char>);
+    view = detail::rtrim_sep(view);
     if (view.empty())
         return sep;  // there was only separator(s) remaining
 
@@ -275,7 +556,7 @@ ltrim_sep(const String& path) noexcept
 {
     auto view = string::to_string_view(path);
     if (!view.empty())
-        view = string::ltrim_if(view, is_sep<Char>);
+        view = detail::ltrim_sep(view);
     return view;
 }
 
@@ -290,7 +571,7 @@ rtrim_sep(const String& path) noexcept
 {
     auto view = string::to_string_view(path);
     if (!view.empty())
-        view = string::rtrim_if(view, is_sep<Char>);
+        view = detail::rtrim_sep(view);
     return view;
 }
 
@@ -321,6 +602,85 @@ join(const Container& elements) noexcept
 }
 
 
+template <
+    typename String,
+    typename Char>
+inline std::enable_if_t<
+    string::is_string_viewable_v<String>,
+    detail::component_range<Char>>
+components(const String& path) noexcept
+{
+    return detail::component_range<Char>{string::to_string_view(path)};
+}
+
+
+template <
+    typename String,
+    typename OutContainer,
+    typename Char>
+inline std::enable_if_t<
+    string::is_string_viewable_v<String> &&
+    std::is_class_v<OutContainer>,
+    OutContainer&>
+normalize_to(const String& path, OutContainer& out)
+{
+    const auto view = string::to_string_view(path);
+    const auto offset = out.size();
+
+    out.resize(offset + view.size());
+    out.resize(offset + detail::normalize(view, out.data() + offset));
+
+    return out;
+}
+
+
+template <
+    typename String,
+    typename Char>
+inline std::enable_if_t<
+    string::is_string_viewable_v<String>,
+    std::size_t>
+normalize_to(const String& path, Char* out) noexcept
+{
+    return detail::normalize(string::to_string_view(path), out);
+}
+
+
+template <
+    typename OutContainer,
+    typename String,
+    typename... Args,
+    typename Char>
+inline std::enable_if_t<
+    string::is_string_viewable_v<String>,
+    OutContainer&>
+join_to(OutContainer& out, const String& head, Args&&... args)
+{
+    string::detail::join_append(
+        out, std::basic_string_view<Char>(native_sep_str<Char>), false, true,
+        head, args...);
+
+    return out;
+}
+
+
+template <
+    typename OutContainer,
+    typename Container,
+    typename Char>
+inline std::enable_if_t<
+    string::is_container_of_strings_v<Container>,
+    OutContainer&>
+join_to(OutContainer& out, const Container& elements)
+{
+    string::detail::join_append_range(
+        out, std::basic_string_view<Char>(native_sep_str<Char>), false, true,
+        std::begin(elements), std::end(elements));
+
+    return out;
+}
+
+
 template <
     typename String,
     typename... Args,
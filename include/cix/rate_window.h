@@ -0,0 +1,195 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+
+namespace detail::rate_window
+{
+    // a small, stable index per thread, assigned round-robin on first use
+    inline std::size_t thread_index() noexcept
+    {
+        static std::atomic<std::size_t> next{0};
+        static thread_local const std::size_t index =
+            next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+}
+
+
+// Event counters over a sliding time window of *Buckets* buckets of
+// bucket_ms() milliseconds each, e.g. to get the rate of requests per second
+// over the last minute without storing every timestamp.
+//
+// Buckets are indexed by `ticks_now() / bucket_ms()` modulo *Buckets*, and
+// each of them holds the bucket number it was last written for, so expired
+// buckets are zeroed lazily by the first increment that reuses them.
+//
+// Counters are sharded: each thread increments the copy of its own shard,
+// which lives on cache lines of its own, so that add() is usually a single
+// relaxed compare-and-swap without contention under heavy fan-in. Readers sum
+// all the shards.
+//
+// CAUTION: a bucket count is 32-bit wide per shard and saturates at
+// max_count, and add() calls delayed by more than the window span are
+// dropped when their slot has already been reused by a more recent bucket.
+template <std::size_t Buckets, std::size_t Shards = 16>
+class rate_window
+{
+public:
+    typedef std::uint64_t count_type;
+
+    // maximal count of a bucket in a shard, add() saturates
+    static constexpr count_type max_count = 0xffffffff;
+
+    static_assert(Buckets > 0 && Buckets < std::numeric_limits<std::uint32_t>::max());
+    static_assert(Shards > 0);
+
+public:
+    CIX_NONCOPYABLE(rate_window)
+    CIX_NONMOVABLE(rate_window)
+
+    explicit rate_window(ticks_t bucket_ms=ticks_second)
+        : m_bucket_ms{bucket_ms}
+    {
+        if (!bucket_ms)
+            CIX_THROW_BADARG("rate_window: invalid bucket duration ({})", bucket_ms);
+
+        this->clear();
+    }
+
+    ~rate_window() = default;
+
+    static constexpr std::size_t buckets() noexcept { return Buckets; }
+    ticks_t bucket_ms() const noexcept { return m_bucket_ms; }
+
+    // duration of the window
+    ticks_t span() const noexcept { return Buckets * m_bucket_ms; }
+
+    void clear() noexcept
+    {
+        for (auto& shard : m_shards)
+        {
+            for (auto& slot : shard.slots)
+                slot.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void add(count_type count=1) noexcept
+    {
+        this->add(count, ticks_now());
+    }
+
+    // *now* allows to amortize the cost of ticks_now() over several calls
+    void add(count_type count, ticks_t now) noexcept
+    {
+        const auto bucket = static_cast<std::uint32_t>(now / m_bucket_ms);
+        auto& slot =
+            m_shards[detail::rate_window::thread_index() % Shards]
+                .slots[bucket % Buckets];
+        auto value = slot.load(std::memory_order_relaxed);
+
+        count = std::min(count, max_count);
+
+        for (;;)
+        {
+            std::uint64_t desired;
+
+            if (bucket_of(value) == bucket)
+            {
+                // saturate rather than carry into the bucket number
+                const auto current = value & max_count;
+                if (current == max_count)
+                    return;
+
+                desired = value + std::min(count, max_count - current);
+            }
+            else if (
+                (value & max_count) &&
+                static_cast<std::int32_t>(bucket - bucket_of(value)) < 0)
+            {
+                // the slot holds a more recent bucket, *now* is too old to be
+                // accounted for (an empty slot can be reset regardless)
+                return;
+            }
+            else
+            {
+                // expired, reset it
+                desired = (std::uint64_t{bucket} << 32) | count;
+            }
+
+            if (slot.compare_exchange_weak(
+                    value, desired, std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+    }
+
+    // number of events over the window ending at *now*
+    count_type total(ticks_t now) const noexcept
+    {
+        const auto bucket = static_cast<std::uint32_t>(now / m_bucket_ms);
+        count_type total = 0;
+
+        for (const auto& shard : m_shards)
+        {
+            for (const auto& slot : shard.slots)
+            {
+                const auto value = slot.load(std::memory_order_relaxed);
+                const auto age = static_cast<std::uint32_t>(bucket - bucket_of(value));
+
+                if (age < Buckets)
+                    total += value & max_count;
+            }
+        }
+
+        return total;
+    }
+
+    count_type total() const noexcept
+    {
+        return this->total(ticks_now());
+    }
+
+    // Events per second over the window ending at *now*.
+    // CAUTION: the current bucket is only partially elapsed, so the rate is
+    // underestimated by up to one bucket.
+    double rate(ticks_t now) const noexcept
+    {
+        return
+            static_cast<double>(this->total(now)) *
+            static_cast<double>(ticks_second) /
+            static_cast<double>(this->span());
+    }
+
+    double rate() const noexcept
+    {
+        return this->rate(ticks_now());
+    }
+
+
+private:
+    // a slot packs a bucket number in its high 32 bits, and its count in the
+    // low 32 bits
+    static std::uint32_t bucket_of(std::uint64_t value) noexcept
+    {
+        return static_cast<std::uint32_t>(value >> 32);
+    }
+
+    struct alignas(cache_line_size) shard_t
+    {
+        std::array<std::atomic<std::uint64_t>, Buckets> slots;
+    };
+
+
+private:
+    const ticks_t m_bucket_ms;
+    std::array<shard_t, Shards> m_shards;
+};
+
+}  // namespace cix
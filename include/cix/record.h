@@ -0,0 +1,147 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+
+// Framed records, typically to be appended to logs and pipes.
+//
+// A frame is made of:
+//
+//   std::uint8_t  magic[2]          // record_magic
+//   varint        length            // LEB128, 1 to 5 bytes
+//   std::uint8_t  payload[length]
+//   std::uint32_t crc32             // little endian; crc32 of length+payload
+//
+// The magic bytes allow record_reader to resynchronize on the next frame
+// after a corrupted one.
+namespace record {
+    typedef memstream::size_type size_type;
+
+    static constexpr std::uint8_t magic[2] = { 0xc1, 0x7a };
+    static constexpr size_type max_varint_size = 5;
+    static constexpr size_type max_overhead =
+        sizeof(magic) + max_varint_size + sizeof(std::uint32_t);
+    static constexpr size_type min_frame_size =
+        sizeof(magic) + 1 + sizeof(std::uint32_t);
+
+    // size of a frame holding a payload of *length* bytes
+    constexpr size_type frame_size(size_type length) noexcept
+    {
+        size_type varint_size = 1;
+        for (auto v = length >> 7; v; v >>= 7)
+            ++varint_size;
+        return sizeof(magic) + varint_size + length + sizeof(std::uint32_t);
+    }
+}
+
+
+// a read-only, non-owning view to a record payload
+struct record_view
+{
+    const std::uint8_t* data = nullptr;
+    record::size_type size = 0;
+
+    bool empty() const { return size == 0; }
+    const std::uint8_t* begin() const { return data; }
+    const std::uint8_t* end() const { return data + size; }
+};
+
+
+// Append records to a memstream, many records per buffer.
+//
+// Frames are encoded in-place, directly in the buffer of the stream.
+class record_writer
+{
+public:
+    typedef record::size_type size_type;
+
+public:
+    CIX_NONCOPYABLE(record_writer)
+
+    explicit record_writer(memstream& stream);
+    ~record_writer() = default;
+
+    memstream& stream();
+
+    // number of records written so far
+    size_type count() const;
+
+    record_writer& write(const void* payload, size_type size);
+    record_writer& write(const record_view& payload);
+
+private:
+    memstream& m_stream;
+    size_type m_count;
+};
+
+
+// Iterate over the records of a buffer, without copying.
+//
+// Corrupted frames are skipped and the reader resynchronizes on the next
+// valid frame. A frame whose declared length goes past the end of the buffer is
+// considered incomplete - i.e. not fully written yet - even if its length is
+// the corrupted part: it stops the iteration without being counted as
+// corrupted, and tell() then points to its first byte. If the buffer is known
+// to be complete, skip() moves past it.
+class record_reader
+{
+public:
+    typedef record::size_type size_type;
+
+    static constexpr size_type default_max_record_size = 64 * 1024 * 1024;
+
+public:
+    record_reader(
+        const void* data, size_type size,
+        size_type max_record_size=default_max_record_size);
+
+    // read from the beginning of *stream*
+    explicit record_reader(
+        const memstream& stream,
+        size_type max_record_size=default_max_record_size);
+
+    ~record_reader() = default;
+
+    // get the next valid record, if any
+    // CAUTION: *out* points to the buffer passed to the constructor
+    bool next(record_view& out);
+
+    // skip the frame at tell() and resynchronize on the next magic bytes,
+    // counting it as corrupted, typically after next() stopped on an
+    // incomplete frame while no more data is expected
+    void skip();
+
+    // offset of the first byte not consumed yet
+    size_type tell() const;
+
+    // number of valid records read so far
+    size_type count() const;
+
+    // number of corrupted frames skipped so far
+    size_type corrupted() const;
+
+    // number of bytes skipped so far due to corruption
+    size_type skipped_bytes() const;
+
+private:
+    enum class parse_result { valid, corrupted, incomplete };
+
+    parse_result parse(size_type pos, record_view& out, size_type& frame_size) const;
+    size_type find_magic(size_type from) const;
+
+private:
+    const std::uint8_t* m_data;
+    size_type m_size;
+    size_type m_max_record_size;
+    size_type m_pos;
+    size_type m_count;
+    size_type m_corrupted;
+    size_type m_skipped;
+};
+
+}  // namespace cix
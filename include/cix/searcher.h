@@ -0,0 +1,239 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+namespace string {
+
+namespace detail::searcher
+{
+    typedef std::array<size_type, 256> skip_table;
+
+    // Boyer-Moore-Horspool, the bad character table being indexed by the low
+    // byte of a character so that it remains small for wide strings
+    template <typename Char>
+    inline size_type bmh_find(
+        const Char* haystack, size_type size,
+        const Char* needle, size_type needle_size,
+        const skip_table& skip) noexcept
+    {
+        assert(needle_size > 0);
+
+        const auto last = needle_size - 1;
+        size_type pos = 0;
+
+        while (pos + last < size)
+        {
+            const auto c = haystack[pos + last];
+
+            if (c == needle[last] &&
+                std::char_traits<Char>::compare(haystack + pos, needle, last) == 0)
+            {
+                return pos;
+            }
+
+            pos += skip[static_cast<std::make_unsigned_t<Char>>(c) & 0xff];
+        }
+
+        return npos;
+    }
+
+    // SIMD version for 1-byte characters, see searcher.cpp
+    size_type find_bytes(
+        const void* haystack, size_type size,
+        const void* needle, size_type needle_size,
+        const skip_table& skip) noexcept;
+}
+
+
+// A string pattern compiled once to be searched for many times, typically by
+// replace_all() or find_all() over a large number of inputs.
+//
+// Search is a Boyer-Moore-Horspool. For strings of 1-byte characters and when
+// SSE2 or AVX2 is available, candidates are first filtered 16 or 32 positions
+// at once by comparing the first and last characters of the pattern, and only
+// then compared in full.
+//
+// An empty pattern never matches.
+template <typename Char>
+class basic_searcher
+{
+public:
+    typedef Char char_type;
+    typedef std::basic_string_view<Char> view_type;
+    typedef string::size_type size_type;
+
+public:
+    explicit basic_searcher(view_type pattern)
+        : m_pattern{pattern}
+    {
+        const auto size = m_pattern.size();
+
+        m_skip.fill(size ? size : 1);
+
+        for (size_type idx = 0; idx + 1 < size; ++idx)
+        {
+            const auto c = static_cast<std::make_unsigned_t<Char>>(m_pattern[idx]);
+            m_skip[c & 0xff] = size - 1 - idx;
+        }
+    }
+
+    template <
+        typename String,
+        typename std::enable_if_t<
+            is_string_viewable_v<String> &&
+            std::is_same_v<char_t<String>, Char>, int> = 0>
+    explicit basic_searcher(const String& pattern)
+        : basic_searcher(to_string_view(pattern))
+        { }
+
+    view_type pattern() const noexcept { return m_pattern; }
+    size_type size() const noexcept { return m_pattern.size(); }
+    bool empty() const noexcept { return m_pattern.empty(); }
+
+    // offset of the first occurrence of the pattern in *haystack*, starting
+    // from offset *pos*, npos if none
+    size_type find(view_type haystack, size_type pos=0) const noexcept
+    {
+        if (m_pattern.empty() ||
+            pos > haystack.size() ||
+            haystack.size() - pos < m_pattern.size())
+        {
+            return npos;
+        }
+
+        size_type res;
+
+        if constexpr (sizeof(Char) == 1)
+        {
+            res = detail::searcher::find_bytes(
+                haystack.data() + pos, haystack.size() - pos,
+                m_pattern.data(), m_pattern.size(),
+                m_skip);
+        }
+        else
+        {
+            res = detail::searcher::bmh_find(
+                haystack.data() + pos, haystack.size() - pos,
+                m_pattern.data(), m_pattern.size(),
+                m_skip);
+        }
+
+        return (res == npos) ? npos : pos + res;
+    }
+
+private:
+    std::basic_string<Char> m_pattern;
+    detail::searcher::skip_table m_skip;
+};
+
+typedef basic_searcher<char> searcher;
+typedef basic_searcher<wchar_t> wsearcher;
+
+
+
+// replace_all (precompiled pattern)
+template <
+    typename StringA,
+    typename StringC,
+    typename Char>
+std::enable_if_t<
+        is_string_viewable_v<StringA> &&
+        is_string_viewable_v<StringC> &&
+        std::is_same_v<char_t<StringA>, Char> &&
+        std::is_same_v<char_t<StringC>, Char>,
+    std::basic_string<Char>>
+replace_all(
+    const StringA& input,
+    const basic_searcher<Char>& from,
+    const StringC& to);
+
+// find_all (precompiled pattern)
+// offsets of the non-overlapping occurrences of *pattern* in *input*
+template <
+    typename String,
+    typename Char>
+std::enable_if_t<
+    is_string_viewable_v<String> && std::is_same_v<char_t<String>, Char>,
+    std::vector<size_type>>
+find_all(
+    const String& input,
+    const basic_searcher<Char>& pattern);
+
+
+
+template <
+    typename StringA,
+    typename StringC,
+    typename Char>
+inline std::enable_if_t<
+        is_string_viewable_v<StringA> &&
+        is_string_viewable_v<StringC> &&
+        std::is_same_v<char_t<StringA>, Char> &&
+        std::is_same_v<char_t<StringC>, Char>,
+    std::basic_string<Char>>
+replace_all(
+    const StringA& input_,
+    const basic_searcher<Char>& from,
+    const StringC& to_)
+{
+    const auto input = to_string_view(input_);
+    const auto to = to_string_view(to_);
+
+    std::basic_string<Char> out;
+
+    if (input.empty())
+        return out;
+
+    out.reserve(input.size());
+
+    size_type start = 0;
+
+    for (;;)
+    {
+        const auto pos = from.find(input, start);
+
+        if (pos == npos)
+        {
+            out.append(input.substr(start));
+            break;
+        }
+
+        out.append(input.substr(start, pos - start));
+        out.append(to);
+
+        start = pos + from.size();
+    }
+
+    return out;
+}
+
+
+template <
+    typename String,
+    typename Char>
+inline std::enable_if_t<
+    is_string_viewable_v<String> && std::is_same_v<char_t<String>, Char>,
+    std::vector<size_type>>
+find_all(
+    const String& input_,
+    const basic_searcher<Char>& pattern)
+{
+    const auto input = to_string_view(input_);
+    std::vector<size_type> out;
+
+    for (auto pos = pattern.find(input); pos != npos;
+        pos = pattern.find(input, pos + pattern.size()))
+    {
+        out.push_back(pos);
+    }
+
+    return out;
+}
+
+}  // namespace string
+}  // namespace cix
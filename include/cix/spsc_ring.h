@@ -0,0 +1,206 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+
+// A bounded, lock-free, single-producer/single-consumer FIFO queue.
+//
+// Unlike `cix::circular`, items are never overwritten: pushing to a full
+// queue fails. Exactly one thread may push and exactly one thread may pop
+// concurrently.
+//
+// Head and tail cursors are free-running counters, each on a cache line of
+// its own, published with release semantics and observed with acquire
+// semantics. Each side also caches the last observed value of the other
+// side's cursor so that the shared cache line is only read when the queue
+// looks full (producer) or empty (consumer).
+template <typename T, std::size_t N>
+class spsc_ring
+{
+public:
+    typedef std::size_t size_type;
+    typedef T value_type;
+    typedef value_type& reference;
+    typedef const value_type& const_reference;
+    typedef value_type* pointer;
+    typedef const value_type* const_pointer;
+
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two");
+    static_assert(std::is_default_constructible_v<T>);
+
+public:
+    CIX_NONCOPYABLE(spsc_ring)
+    CIX_NONMOVABLE(spsc_ring)
+
+    spsc_ring() noexcept
+        : m_tail{0}
+        , m_head_cache{0}
+        , m_head{0}
+        , m_tail_cache{0}
+        { }
+
+    ~spsc_ring() = default;
+
+    static constexpr size_type capacity() noexcept
+    {
+        return N;
+    }
+
+    // approximate if called concurrently with push or pop operations
+    size_type size() const noexcept
+    {
+        const auto head = m_head.load(std::memory_order_acquire);
+        const auto tail = m_tail.load(std::memory_order_acquire);
+        return (tail >= head) ? (tail - head) : 0;
+    }
+
+    // approximate if called concurrently with push or pop operations
+    bool empty() const noexcept
+    {
+        return this->size() == 0;
+    }
+
+
+    // producer side
+
+    bool try_push(const_reference item)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        if (!this->writable(tail, 1))
+            return false;
+
+        m_buffer[tail & mask] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(value_type&& item)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        if (!this->writable(tail, 1))
+            return false;
+
+        m_buffer[tail & mask] = std::move(item);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // push up to *count* items, in at most two contiguous copies
+    // returns the number of items pushed
+    size_type push_n(const_pointer items, size_type count)
+    {
+        assert(items || !count);
+
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        count = std::min(count, this->writable(tail, count));
+        if (!count)
+            return 0;
+
+        const auto start = tail & mask;
+        const auto first = std::min(count, N - start);
+
+        std::copy_n(items, first, m_buffer.begin() + start);
+        std::copy_n(items + first, count - first, m_buffer.begin());
+
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+
+    // consumer side
+
+    bool try_pop(reference item)
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (!this->readable(head, 1))
+            return false;
+
+        item = std::move(m_buffer[head & mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // pop up to *count* items, in at most two contiguous copies
+    // returns the number of items popped
+    size_type pop_n(pointer items, size_type count)
+    {
+        assert(items || !count);
+
+        const auto head = m_head.load(std::memory_order_relaxed);
+        count = std::min(count, this->readable(head, count));
+        if (!count)
+            return 0;
+
+        const auto start = head & mask;
+        const auto first = std::min(count, N - start);
+
+        std::move(
+            m_buffer.begin() + start,
+            m_buffer.begin() + start + first,
+            items);
+        std::move(
+            m_buffer.begin(),
+            m_buffer.begin() + (count - first),
+            items + first);
+
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // access the oldest item without popping it, null if queue is empty
+    // CAUTION: consumer side only
+    pointer front() noexcept
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        return this->readable(head, 1) ? &m_buffer[head & mask] : nullptr;
+    }
+
+
+private:
+    static constexpr size_type mask = N - 1;
+
+    // producer side: number of free slots, refresh cached head only if less
+    // than *wanted*
+    size_type writable(size_type tail, size_type wanted) noexcept
+    {
+        auto free = N - (tail - m_head_cache);
+        if (free < wanted)
+        {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            free = N - (tail - m_head_cache);
+        }
+        return free;
+    }
+
+    // consumer side: number of available items, refresh cached tail only if
+    // less than *wanted*
+    size_type readable(size_type head, size_type wanted) noexcept
+    {
+        auto avail = m_tail_cache - head;
+        if (avail < wanted)
+        {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+            avail = m_tail_cache - head;
+        }
+        return avail;
+    }
+
+
+private:
+    // written by producer
+    alignas(cache_line_size) std::atomic<size_type> m_tail;
+    size_type m_head_cache;
+
+    // written by consumer
+    alignas(cache_line_size) std::atomic<size_type> m_head;
+    size_type m_tail_cache;
+
+    alignas(cache_line_size) std::array<value_type, N> m_buffer;
+};
+
+}  // namespace cix
@@ -247,12 +247,20 @@ finalize(
 
 
 // widen (utf-8 to wchar_t)
-#ifdef _WIN32
+//
+// wchar_t strings are UTF-16 on Windows, and UTF-32 on other platforms.
+//
+// u8tow() returns an empty string if *input* is not valid UTF-8, while
+// u8towrepl() replaces invalid sequences with U+FFFD.
+//
+// Only runs of ASCII are converted in blocks, 32 bytes at a time with SSE2
+// when available. Multi-byte sequences are decoded one at a time, i.e. text
+// with few ASCII characters, like CJK, is converted at scalar speed.
 template <
     typename String,
     typename Char = char_t<String>>
 std::enable_if_t<
-    is_string_viewable_v<String> && std::is_same_v<signed char, Char>,
+    is_string_viewable_v<String> && std::is_same_v<char, Char>,
     std::wstring>
 u8towrepl(const String& input);
 
@@ -260,15 +268,19 @@ template <
     typename String,
     typename Char = char_t<String>>
 std::enable_if_t<
-    is_string_viewable_v<String> && std::is_same_v<signed char, Char>,
+    is_string_viewable_v<String> && std::is_same_v<char, Char>,
     std::wstring>
 u8tow(const String& input);
-#endif
 
 
 // narrow (wchar_t to utf-8)
-// CAUTION: wtou8() behaves like wtou8repl() on pre-Vista platforms
-#ifdef _WIN32
+//
+// wtou8() returns an empty string if *input* is not valid UTF-16 (UTF-32 on
+// non-Windows platforms), i.e. in case of unpaired surrogates, while
+// wtou8repl() replaces invalid code units with U+FFFD.
+//
+// Only runs of ASCII are converted in blocks, 16 code units at a time with
+// SSE2 when available. Other code points are encoded one at a time.
 template <
     typename String,
     typename Char = char_t<String>>
@@ -284,7 +296,30 @@ std::enable_if_t<
     is_string_viewable_v<String> && std::is_same_v<wchar_t, Char>,
     std::string>
 wtou8(const String& input);
-#endif
+
+
+// utf8_validate
+//
+// Return the offset of the first invalid sequence in *input*, or
+// `cix::string::npos` if *input* is valid UTF-8. Overlong forms, surrogates
+// and code points above U+10FFFF are invalid, as well as a truncated sequence
+// at the end of *input*.
+//
+// Input is checked 16 or 32 bytes at a time when SSSE3 or AVX2 is available.
+// With SSE2 only, which is the default of MSVC x64, runs of ASCII are skipped
+// 16 bytes at a time and other sequences are checked one at a time. Instruction
+// sets are selected at compile time, e.g. with /arch:AVX2 or -mavx2.
+size_type utf8_validate(std::string_view input) noexcept;
+
+
+// utf8_count
+//
+// Return the number of code points in *input*, or `cix::string::npos` if it is
+// not valid UTF-8. In both cases, *error_offset* is set to the value
+// `cix::string::utf8_validate` would return, if not null.
+size_type utf8_count(
+    std::string_view input,
+    size_type* error_offset=nullptr) noexcept;
 
 
 // split_any_of
@@ -327,6 +362,82 @@ split(
     size_type max_split=0);
 
 
+namespace detail
+{
+    template <typename Char, typename Finder> class split_range;
+    template <typename Char> struct split_any_of_finder;
+    template <typename Char, typename UnaryPredicate> struct split_if_finder;
+}
+
+// split_any_of_view
+//
+// Lazy equivalent of `cix::string::split_any_of`: returns a forward range that
+// yields the same views on demand, without allocating.
+//
+// CAUTION: the range refers to the data of *input* and *seps*, which must
+// outlive it.
+template <
+    typename StringA,
+    typename StringB,
+    typename Char = char_t<StringA>>
+constexpr std::enable_if_t<
+    is_string_viewable_v<StringA> &&
+    is_string_viewable_v<StringB> &&
+    std::is_same_v<char_t<StringA>, char_t<StringB>>,
+    detail::split_range<Char, detail::split_any_of_finder<Char>>>
+split_any_of_view(
+    const StringA& input,
+    const StringB& seps,
+    size_type max_split=0);
+
+// split_if_view
+// lazy equivalent of `cix::string::split_if`
+template <
+    typename String,
+    typename UnaryPredicate,
+    typename Char = char_t<String>>
+constexpr std::enable_if_t<
+    is_string_viewable_v<String>,
+    detail::split_range<Char, detail::split_if_finder<Char, UnaryPredicate>>>
+split_if_view(
+    const String& input,
+    UnaryPredicate pred,
+    size_type max_split=0);
+
+// split_view
+// lazy equivalent of `cix::string::split` (split on whitespaces)
+template <
+    typename String,
+    typename Char = char_t<String>>
+constexpr std::enable_if_t<
+    is_string_viewable_v<String>,
+    detail::split_range<Char, detail::split_if_finder<Char, bool(*)(Char)>>>
+split_view(
+    const String& input,
+    size_type max_split=0);
+
+// split_into
+//
+// Split *input* like `cix::string::split_any_of` into at most N fields, the
+// last one holding the remainder of *input* if needed (i.e. the whole of it if
+// N is 1). Return the number of fields found. Unused elements of *out* are
+// cleared.
+template <
+    typename StringA,
+    typename StringB,
+    std::size_t N,
+    typename Char = char_t<StringA>>
+constexpr std::enable_if_t<
+    is_string_viewable_v<StringA> &&
+    is_string_viewable_v<StringB> &&
+    std::is_same_v<char_t<StringA>, char_t<StringB>>,
+    size_type>
+split_into(
+    const StringA& input,
+    const StringB& seps,
+    std::array<std::basic_string_view<Char>, N>& out);
+
+
 
 // join (variadic)
 template <
@@ -359,6 +470,45 @@ join(
     const String& glue,
     const Container& elements) noexcept;
 
+// join_to (variadic)
+//
+// Append the result of `cix::string::join` to *out*, a container of
+// characters like std::basic_string, so that a buffer can be reused. Content
+// already in *out* is left as-is, without glue.
+template <
+    typename OutContainer,
+    typename StringA,
+    typename StringB,
+    typename... Args,
+    typename Char = char_t<StringA>>
+std::enable_if_t<
+        is_string_viewable_v<StringA> &&
+        is_string_viewable_v<StringB> &&
+        std::is_same_v<char_t<StringA>, char_t<StringB>>,
+    OutContainer&>
+join_to(
+    OutContainer& out,
+    const StringA& glue,
+    const StringB& head,
+    Args&&... args);
+
+// join_to (from a container of strings)
+template <
+    typename OutContainer,
+    typename String,
+    typename Container,
+    typename CharA = char_t<String>,
+    typename CharB = is_container_of_strings<Container>::char_type>
+std::enable_if_t<
+        is_string_viewable_v<String> &&
+        is_container_of_strings_v<Container> &&
+        std::is_same_v<CharA, CharB>,
+    OutContainer&>
+join_to(
+    OutContainer& out,
+    const String& glue,
+    const Container& elements);
+
 
 
 // melt (variadic)
@@ -521,6 +671,23 @@ replace_all(
     const StringC& to);
 
 
+// find_all
+// offsets of the non-overlapping occurrences of *pattern* in *input*, see also
+// `cix::string::searcher`
+template <
+    typename StringA,
+    typename StringB,
+    typename Char = char_t<StringA>>
+std::enable_if_t<
+        is_string_viewable_v<StringA> &&
+        is_string_viewable_v<StringB> &&
+        std::is_same_v<char_t<StringA>, char_t<StringB>>,
+    std::vector<size_type>>
+find_all(
+    const StringA& input,
+    const StringB& pattern);
+
+
 // replace_all_of
 template <
     typename StringA,
@@ -651,6 +818,10 @@ std::enable_if_t<is_char_v<Char>, Char>
 to_lower(Char c);
 
 // to_lower(String)
+//
+// ASCII characters are converted several at a time, the others one by one by
+// the `std::ctype` facet of the classic locale. This also applies to the
+// to_lower_* and to_upper* functions below.
 template <
     typename String,
     typename Char = char_t<String>>
@@ -659,6 +830,24 @@ std::enable_if_t<
     std::basic_string<Char>>
 to_lower(const String& input);
 
+// to_lower_inplace
+template <typename Char, typename Traits, typename Alloc>
+std::basic_string<Char, Traits, Alloc>&
+to_lower_inplace(std::basic_string<Char, Traits, Alloc>& str);
+
+template <typename Char>
+Char*
+to_lower_inplace(Char* str, size_type length);
+
+// to_lower_to (OutputIt)
+// write the lower case version of *input* to *out*, without allocating
+template <
+    typename OutputIt,
+    typename String,
+    typename Char = char_t<String>>
+std::enable_if_t<is_string_viewable_v<String>, OutputIt>
+to_lower_to(OutputIt out, const String& input);
+
 
 // to_upper(Char)
 template <typename Char>
@@ -674,6 +863,74 @@ std::enable_if_t<
     std::basic_string<Char>>
 to_upper(const String& input);
 
+// to_upper_inplace
+template <typename Char, typename Traits, typename Alloc>
+std::basic_string<Char, Traits, Alloc>&
+to_upper_inplace(std::basic_string<Char, Traits, Alloc>& str);
+
+template <typename Char>
+Char*
+to_upper_inplace(Char* str, size_type length);
+
+// to_upper_to (OutputIt)
+template <
+    typename OutputIt,
+    typename String,
+    typename Char = char_t<String>>
+std::enable_if_t<is_string_viewable_v<String>, OutputIt>
+to_upper_to(OutputIt out, const String& input);
+
+
+// iequals
+//
+// Case-insensitive equality of *a* and *b*, in which only ASCII letters are
+// folded, so that it remains consistent for UTF-8 strings. Input is compared
+// 16 or 32 bytes at a time when SSE2 or AVX2 is available, 8 bytes at a time
+// otherwise. This also applies to the icompare function below.
+bool iequals(std::string_view a, std::string_view b) noexcept;
+
+// icompare
+// case-insensitive three-way comparison, like std::string_view::compare()
+int icompare(std::string_view a, std::string_view b) noexcept;
+
+// ihash
+// case-insensitive hash, such that iequals(a, b) implies ihash(a) == ihash(b)
+// input is folded and hashed a 64-bit word at a time, without SIMD
+std::size_t ihash(std::string_view input) noexcept;
+
+
+// ci_less, ci_hash, ci_equal
+//
+// Transparent function objects to use narrow strings as case-insensitive
+// keys, like in:
+//
+//   std::map<std::string, T, cix::string::ci_less>
+//   std::unordered_map<
+//       std::string, T, cix::string::ci_hash, cix::string::ci_equal>
+struct ci_less
+{
+    typedef void is_transparent;
+
+    bool operator()(std::string_view a, std::string_view b) const noexcept
+    { return icompare(a, b) < 0; }
+};
+
+struct ci_hash
+{
+    typedef void is_transparent;
+
+    std::size_t operator()(std::string_view input) const noexcept
+    { return ihash(input); }
+};
+
+struct ci_equal
+{
+    typedef void is_transparent;
+
+    bool operator()(std::string_view a, std::string_view b) const noexcept
+    { return iequals(a, b); }
+};
+
 
 }  // namespace string
 }  // namespace cix
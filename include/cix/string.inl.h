@@ -10,95 +10,13 @@ namespace detail
     template <typename Char>
     const auto& cfacet = std::use_facet<std::ctype<Char>>(std::locale::classic());
 
-#ifdef _WIN32
-    inline std::wstring widen(const char* src, size_type len, bool strict)
-    {
-        if (!src || !*src || !len)
-            return {};
-
-        const UINT src_cp = CP_UTF8;
-        const DWORD flags = strict ? MB_ERR_INVALID_CHARS : 0;
-        int ilen;
-
-        // deal with unlikely overflow - MultiByteToWideChar expects an int
-        if (len <= static_cast<size_type>(std::numeric_limits<int>::max()))
-        {
-            ilen = static_cast<int>(len);
-        }
-        else
-        {
-            assert(0);
-            ilen = static_cast<size_type>(std::numeric_limits<int>::max());
-        }
-
-        // get required size
-        int count = MultiByteToWideChar(src_cp, flags, src, ilen, nullptr, 0);
-        if (count <= 0)
-        {
-            assert(0);
-            return {};
-        }
-
-        // convert
-        std::wstring dest(static_cast<size_type>(count), 0);
-        MultiByteToWideChar(src_cp, flags, src, ilen, dest.data(), count);
-        while (dest.back() == 0)
-            dest.erase(dest.size() - 1);
-
-        return dest;
-    }
-#endif  // #ifdef _WIN32
-
-
-#ifdef _WIN32
-    inline std::string narrow(const wchar_t* src, size_type len, bool strict)
-    {
-        if (!src || !*src || !len)
-            return {};
-
-        const UINT dest_cp = CP_UTF8;
-        DWORD flags = 0;
-        int ilen;
-
-        // WC_ERR_INVALID_CHARS flag is supported on Vista or later
-#if (WINVER >= 0x0600) || defined(WC_ERR_INVALID_CHARS)
-        if (strict)
-            flags |= WC_NO_BEST_FIT_CHARS | WC_ERR_INVALID_CHARS;
-#else
-        if (strict)
-            flags |= WC_NO_BEST_FIT_CHARS;
-#endif
-
-        // deal with unlikely overflow - WideCharToMultiByte expects an int
-        if (len <= static_cast<size_type>(std::numeric_limits<int>::max()))
-        {
-            ilen = static_cast<int>(len);
-        }
-        else
-        {
-            assert(0);
-            ilen = static_cast<size_type>(std::numeric_limits<int>::max());
-        }
-
-        // get required size
-        int count = WideCharToMultiByte(
-            dest_cp, flags, src, ilen, nullptr, 0, nullptr, nullptr);
-        if (count <= 0)
-        {
-            assert(0);
-            return {};
-        }
+    // see utf8.cpp
+    std::wstring widen(const char* src, size_type len, bool strict);
+    std::string narrow(const wchar_t* src, size_type len, bool strict);
 
-        // convert
-        std::string dest(static_cast<size_type>(count), 0);
-        WideCharToMultiByte(
-            dest_cp, flags, src, ilen, dest.data(), count, nullptr, nullptr);
-        while (dest.back() == 0)
-            dest.erase(dest.size() - 1);
-
-        return dest;
-    }
-#endif  // #ifdef _WIN32
+    // see case.cpp
+    size_type ascii_to_lower(const char* src, size_type len, char* dest) noexcept;
+    size_type ascii_to_upper(const char* src, size_type len, char* dest) noexcept;
 
 
     // this fmt::arg_formatter forcefully casts signed integers to unsigned when
@@ -159,107 +77,299 @@ namespace detail
 #endif
 
 
+    // strip *glue* from both ends of *elem*
     template <typename Char>
-    inline std::basic_string<Char>
-    join_stub_final(
-        std::size_t final_length,
-        const std::vector<std::basic_string_view<Char>>& glued_views) noexcept
+    constexpr std::basic_string_view<Char>
+    join_trim(
+        std::basic_string_view<Char> elem,
+        std::basic_string_view<Char> glue) noexcept
     {
-        std::basic_string<Char> out;
-
-        out.reserve(final_length);
+        if (!glue.empty())
+        {
+            while (elem.starts_with(glue))
+                elem.remove_prefix(glue.size());
 
-        auto outit = std::back_inserter(out);
-        for (const auto& view : glued_views)
-            std::copy(view.begin(), view.end(), outit);
+            while (elem.ends_with(glue))
+                elem.remove_suffix(glue.size());
+        }
 
-        return out;
+        return elem;
     }
 
-    template <typename Char>
-    inline void
-    join_stub(
-        std::size_t& out_length,
-        std::vector<std::basic_string_view<Char>>& out_views,
+
+    // Append the string-viewable elements in [first, last) to *out*, separated
+    // by *glue*. A first pass computes the final length so that *out* grows
+    // at most once, and the second one copies.
+    template <typename OutContainer, typename Char, typename InputIt>
+    void
+    join_append_range(
+        OutContainer& out,
+        std::basic_string_view<Char> glue,
         bool keep_empty,
         bool trim_glue,
-        const std::basic_string_view<Char>& glue) noexcept
+        InputIt first,
+        InputIt last)
     {
-        CIX_UNUSED(out_length);
-        CIX_UNUSED(out_views);
-        CIX_UNUSED(keep_empty);
-        CIX_UNUSED(trim_glue);
-        CIX_UNUSED(glue);
+        const auto prepare = [&glue, trim_glue](const auto& elem_) {
+            const std::basic_string_view<Char> elem = to_string_view(elem_);
+            return trim_glue ? join_trim(elem, glue) : elem;
+        };
+
+        size_type length = 0;
+        size_type count = 0;
+
+        for (auto it = first; it != last; ++it)
+        {
+            const auto elem = prepare(*it);
+
+            if (keep_empty || !elem.empty())
+            {
+                length += elem.size();
+                ++count;
+            }
+        }
+
+        if (!count)
+            return;
+
+        // grow geometrically, since an exact reserve() would reallocate *out*
+        // on each call when joining repeatedly to the same vector
+        const size_type needed = out.size() + length + (count - 1) * glue.size();
+
+        if (needed > out.capacity())
+            out.reserve(std::max<size_type>(needed, 2 * out.capacity()));
+
+        bool glued = false;
+
+        for (auto it = first; it != last; ++it)
+        {
+            const auto elem = prepare(*it);
+
+            if (!keep_empty && elem.empty())
+                continue;
+
+            if (glued)
+                out.insert(out.end(), glue.begin(), glue.end());
+
+            out.insert(out.end(), elem.begin(), elem.end());
+            glued = true;
+        }
     }
 
+
+    // variadic form of join_append_range(), elements are viewed from an
+    // array on the stack
     template <
+        typename OutContainer,
+        typename Char,
         typename String,
-        typename... Args,
-        typename Char = char_t<String>,
-        typename std::enable_if_t<is_string_viewable_v<String>, int> = 0>
+        typename... Args>
     inline void
-    join_stub(
-        std::size_t& out_length,
-        std::vector<std::basic_string_view<Char>>& out_views,
+    join_append(
+        OutContainer& out,
+        std::basic_string_view<Char> glue,
         bool keep_empty,
         bool trim_glue,
-        const std::basic_string_view<Char>& glue,
-        const String& head_,
-        Args&&... args) noexcept
+        const String& head,
+        Args&&... args)
+    {
+        const std::array<std::basic_string_view<Char>, 1 + sizeof...(Args)>
+            views{
+                std::basic_string_view<Char>(to_string_view(head)),
+                std::basic_string_view<Char>(to_string_view(args))... };
+
+        join_append_range(
+            out, glue, keep_empty, trim_glue, views.begin(), views.end());
+    }
+
+
+    // true if *UnaryPredicate* is a char_set that can be used to search
+    // strings of *Char*
+    template <typename UnaryPredicate, typename Char>
+    inline constexpr bool is_char_set_v =
+        std::is_same_v<std::decay_t<UnaryPredicate>, char_set> &&
+        sizeof(Char) == 1;
+
+
+    // search for any character of a set: a char_set is used for strings of
+    // 1-byte characters, std::basic_string_view::find_first_of() otherwise
+    template <typename Char, typename = void>
+    class any_of
+    {
+    public:
+        constexpr explicit any_of(std::basic_string_view<Char> chars) noexcept
+            : m_chars{chars}
+            { }
+
+        constexpr size_type find_first(
+            std::basic_string_view<Char> s, size_type pos=0) const noexcept
+        {
+            return s.find_first_of(m_chars, pos);
+        }
+
+    private:
+        std::basic_string_view<Char> m_chars;
+    };
+
+    template <typename Char>
+    class any_of<Char, std::enable_if_t<sizeof(Char) == 1>>
     {
-        auto head = to_string_view(head_);
+    public:
+        constexpr explicit any_of(std::basic_string_view<Char> chars) noexcept
+            : m_set{chars}
+            { }
 
-        if (trim_glue && !glue.empty())
+        size_type find_first(
+            std::basic_string_view<Char> s, size_type pos=0) const noexcept
         {
-#if 1  // C++20
-            while (head.starts_with(glue))
-                head.remove_prefix(glue.size());
-
-            while (head.ends_with(glue))
-                head.remove_suffix(glue.size());
-#else
-            const auto glue_size = glue.size();
-
-            // strip prefix
-            while (
-                head.size() >= glue_size &&
-                std::equal(
-                    head.begin(),
-                    std::next(head.begin(), glue_size),
-                    glue.begin()))
+            return m_set.find_first(s, pos);
+        }
+
+    private:
+        char_set m_set;
+    };
+
+
+    template <typename Char>
+    struct split_any_of_finder
+    {
+        // like split_any_of(), an empty input or trailing field is not yielded
+        static constexpr bool empty_tail = false;
+
+        any_of<Char> seps;
+
+        constexpr size_type operator()(std::basic_string_view<Char> s) const
+        {
+            return seps.find_first(s);
+        }
+    };
+
+
+    template <typename Char, typename UnaryPredicate>
+    struct split_if_finder
+    {
+        static constexpr bool empty_tail = true;
+
+        UnaryPredicate pred;
+
+        constexpr size_type operator()(std::basic_string_view<Char> s) const
+        {
+            const auto it = std::find_if(s.begin(), s.end(), pred);
+            return (it == s.end()) ? npos : std::distance(s.begin(), it);
+        }
+    };
+
+
+    template <typename Char, typename Finder>
+    class split_range
+    {
+    public:
+        typedef std::basic_string_view<Char> view_type;
+
+        class iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef view_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const view_type* pointer;
+            typedef const view_type& reference;
+
+        public:
+            constexpr iterator() noexcept = default;
+
+            constexpr iterator(const split_range* range, view_type input)
+                : m_range{range}
             {
-                head.remove_prefix(glue_size);
+                if (input.empty() && !Finder::empty_tail)
+                    m_range = nullptr;
+                else
+                    this->fetch(input);
             }
 
-            // strip suffix
-            while (
-                head.size() >= glue_size &&
-                std::equal(
-                    // this instead of (end - glue_size), so that we stick to
-                    // ForwardIt
-                    std::next(head.begin(), head.size() - glue_size),
-                    head.end(),
-                    glue.begin()))
+            constexpr reference operator*() const noexcept { return m_token; }
+            constexpr pointer operator->() const noexcept { return &m_token; }
+
+            constexpr iterator& operator++()
             {
-                head.remove_suffix(glue_size);
+                if (m_last || (m_tail.empty() && !Finder::empty_tail))
+                    *this = iterator{};
+                else
+                    this->fetch(m_tail);
+
+                return *this;
             }
-#endif
-        }
 
-        if (keep_empty || !head.empty())
-        {
-            if (!out_views.empty())
+            constexpr iterator operator++(int)
             {
-                out_views.push_back(glue);
-                out_length += glue.size();
+                auto tmp = *this;
+                ++*this;
+                return tmp;
             }
 
-            out_views.push_back(head);
-            out_length += head.size();
-        }
+            friend constexpr bool operator==(
+                const iterator& lhs, const iterator& rhs) noexcept
+            {
+                return lhs.m_range == rhs.m_range && lhs.m_count == rhs.m_count;
+            }
 
-        join_stub(out_length, out_views, keep_empty, trim_glue, glue, args...);
-    }
+            friend constexpr bool operator!=(
+                const iterator& lhs, const iterator& rhs) noexcept
+            {
+                return !(lhs == rhs);
+            }
+
+        private:
+            constexpr void fetch(view_type s)
+            {
+                const auto max_split = m_range->m_max_split;
+                const auto pos =
+                    (max_split > 0 && m_count >= max_split) ?
+                    npos : m_range->m_finder(s);
+
+                ++m_count;
+
+                if (pos == npos)
+                {
+                    m_token = s;
+                    m_tail = {};
+                    m_last = true;
+                }
+                else
+                {
+                    m_token = s.substr(0, pos);
+                    m_tail = s.substr(pos + 1);
+                }
+            }
+
+        private:
+            const split_range* m_range = nullptr;
+            view_type m_token;
+            view_type m_tail;
+            size_type m_count = 0;
+            bool m_last = false;
+        };
+
+        typedef iterator const_iterator;
+
+    public:
+        constexpr split_range(
+                view_type input, Finder finder, size_type max_split)
+            : m_input{input}
+            , m_finder{std::move(finder)}
+            , m_max_split{max_split}
+            { }
+
+        constexpr iterator begin() const { return iterator{this, m_input}; }
+        constexpr iterator end() const noexcept { return iterator{}; }
+
+        constexpr bool empty() const { return this->begin() == this->end(); }
+
+    private:
+        view_type m_input;
+        Finder m_finder;
+        size_type m_max_split;
+    };
 
 }  // namespace detail
 
@@ -357,7 +467,6 @@ finalize(
 }
 
 
-#ifdef _WIN32
 template <
     typename String,
     typename Char>
@@ -369,10 +478,8 @@ u8towrepl(const String& input)
     const auto view = to_string_view(input);
     return detail::widen(view.data(), view.length(), false);
 }
-#endif
 
 
-#ifdef _WIN32
 template <
     typename String,
     typename Char>
@@ -384,10 +491,8 @@ u8tow(const String& input)
     const auto view = to_string_view(input);
     return detail::widen(view.data(), view.length(), true);
 }
-#endif
 
 
-#ifdef _WIN32
 template <
     typename String,
     typename Char>
@@ -399,10 +504,8 @@ wtou8repl(const String& input)
     const auto view = to_string_view(input);
     return detail::narrow(view.data(), view.length(), false);
 }
-#endif
 
 
-#ifdef _WIN32
 template <
     typename String,
     typename Char>
@@ -414,7 +517,6 @@ wtou8(const String& input)
     const auto view = to_string_view(input);
     return detail::narrow(view.data(), view.length(), true);
 }
-#endif
 
 
 template <
@@ -432,7 +534,7 @@ split_any_of(
         size_type max_split)
 {
     const auto inputv = to_string_view(input);
-    const auto sepsv = to_string_view(seps);
+    const detail::any_of<Char> sepsv(to_string_view(seps));
     std::vector<std::basic_string_view<Char>> out;
     auto base = inputv.begin();
     decltype(base) it;
@@ -445,9 +547,10 @@ split_any_of(
         }
         else
         {
-            it = std::find_first_of(
-                base, inputv.end(),
-                sepsv.begin(), sepsv.end());
+            const auto pos = sepsv.find_first(
+                inputv, std::distance(inputv.begin(), base));
+
+            it = (pos == npos) ? inputv.end() : std::next(inputv.begin(), pos);
         }
 
         out.push_back(decltype(out)::value_type(&*base, it - base));
@@ -513,6 +616,107 @@ split(
 }
 
 
+template <
+    typename StringA,
+    typename StringB,
+    typename Char>
+inline constexpr std::enable_if_t<
+    is_string_viewable_v<StringA> &&
+    is_string_viewable_v<StringB> &&
+    std::is_same_v<char_t<StringA>, char_t<StringB>>,
+    detail::split_range<Char, detail::split_any_of_finder<Char>>>
+split_any_of_view(
+    const StringA& input,
+    const StringB& seps,
+    size_type max_split)
+{
+    return {
+        to_string_view(input),
+        detail::split_any_of_finder<Char>{
+            detail::any_of<Char>{to_string_view(seps)}},
+        max_split};
+}
+
+
+template <
+    typename String,
+    typename UnaryPredicate,
+    typename Char>
+inline constexpr std::enable_if_t<
+    is_string_viewable_v<String>,
+    detail::split_range<Char, detail::split_if_finder<Char, UnaryPredicate>>>
+split_if_view(
+    const String& input,
+    UnaryPredicate pred,
+    size_type max_split)
+{
+    return {
+        to_string_view(input),
+        detail::split_if_finder<Char, UnaryPredicate>{std::move(pred)},
+        max_split};
+}
+
+
+template <
+    typename String,
+    typename Char>
+inline constexpr std::enable_if_t<
+    is_string_viewable_v<String>,
+    detail::split_range<Char, detail::split_if_finder<Char, bool(*)(Char)>>>
+split_view(
+    const String& input,
+    size_type max_split)
+{
+    return split_if_view<String, bool(*)(Char)>(
+        input, &isspace<Char>, max_split);
+}
+
+
+template <
+    typename StringA,
+    typename StringB,
+    std::size_t N,
+    typename Char>
+inline constexpr std::enable_if_t<
+    is_string_viewable_v<StringA> &&
+    is_string_viewable_v<StringB> &&
+    std::is_same_v<char_t<StringA>, char_t<StringB>>,
+    size_type>
+split_into(
+    const StringA& input,
+    const StringB& seps,
+    std::array<std::basic_string_view<Char>, N>& out)
+{
+    static_assert(N > 0);
+
+    // a max_split of 0 would mean no limit, the only field is the remainder,
+    // i.e. the whole input
+    if constexpr (N == 1)
+    {
+        const auto view = to_string_view(input);
+        out[0] = view;
+        return view.empty() ? 0 : 1;
+    }
+    else
+    {
+        size_type count = 0;
+
+        for (const auto& field : split_any_of_view(input, seps, N - 1))
+        {
+            if (count == N)
+                break;
+
+            out[count++] = field;
+        }
+
+        for (auto idx = count; idx < N; ++idx)
+            out[idx] = {};
+
+        return count;
+    }
+}
+
+
 template <
     typename StringA,
     typename StringB,
@@ -528,16 +732,12 @@ join(
     const StringB& head,
     Args&&... args) noexcept
 {
-    std::vector<std::basic_string_view<Char>> glued_views;
-    std::size_t final_strlen = 0;
-    const auto glue = to_string_view(glue_);
-
-    glued_views.reserve(2 * (1 + sizeof...(args)));  // +1 for glue and head
+    std::basic_string<Char> out;
 
-    detail::join_stub(
-        final_strlen, glued_views, true, false, glue, head, args...);
+    detail::join_append(
+        out, to_string_view(glue_), true, false, head, args...);
 
-    return detail::join_stub_final(final_strlen, glued_views);
+    return out;
 }
 
 
@@ -555,19 +755,61 @@ join(
     const String& glue_,
     const Container& elements) noexcept
 {
-    if (elements.empty())
-        return {};
+    std::basic_string<CharA> out;
+
+    detail::join_append_range(
+        out, to_string_view(glue_), true, false,
+        std::begin(elements), std::end(elements));
 
-    std::vector<std::basic_string_view<CharA>> glued_views;
-    std::size_t final_strlen = 0;
-    const auto glue = to_string_view(glue_);
+    return out;
+}
 
-    glued_views.reserve(2 * elements.size());
 
-    for (const auto& elem : elements)
-        detail::join_stub(final_strlen, glued_views, true, false, glue, elem);
+template <
+    typename OutContainer,
+    typename StringA,
+    typename StringB,
+    typename... Args,
+    typename Char>
+inline std::enable_if_t<
+        is_string_viewable_v<StringA> &&
+        is_string_viewable_v<StringB> &&
+        std::is_same_v<char_t<StringA>, char_t<StringB>>,
+    OutContainer&>
+join_to(
+    OutContainer& out,
+    const StringA& glue,
+    const StringB& head,
+    Args&&... args)
+{
+    detail::join_append(
+        out, to_string_view(glue), true, false, head, args...);
+
+    return out;
+}
+
+
+template <
+    typename OutContainer,
+    typename String,
+    typename Container,
+    typename CharA,
+    typename CharB>
+inline std::enable_if_t<
+        is_string_viewable_v<String> &&
+        is_container_of_strings_v<Container> &&
+        std::is_same_v<CharA, CharB>,
+    OutContainer&>
+join_to(
+    OutContainer& out,
+    const String& glue,
+    const Container& elements)
+{
+    detail::join_append_range(
+        out, to_string_view(glue), true, false,
+        std::begin(elements), std::end(elements));
 
-    return detail::join_stub_final(final_strlen, glued_views);
+    return out;
 }
 
 
@@ -586,16 +828,12 @@ melt(
     const StringB& head,
     Args&&... args) noexcept
 {
-    std::vector<std::basic_string_view<Char>> glued_views;
-    std::size_t final_strlen = 0;
-    const auto glue_view = to_string_view(glue);
-
-    glued_views.reserve(2 * (1 + sizeof...(args)));  // +1 for glue_view and head
+    std::basic_string<Char> out;
 
-    detail::join_stub(
-        final_strlen, glued_views, false, false, glue_view, head, args...);
+    detail::join_append(
+        out, to_string_view(glue), false, false, head, args...);
 
-    return detail::join_stub_final(final_strlen, glued_views);
+    return out;
 }
 
 
@@ -613,20 +851,13 @@ melt(
     const String& glue,
     const Container& elements) noexcept
 {
-    if (elements.empty())
-        return {};
+    std::basic_string<CharA> out;
 
-    std::vector<std::basic_string_view<CharA>> glued_views;
-    std::size_t final_strlen = 0;
-    const auto glue_view = to_string_view(glue);
+    detail::join_append_range(
+        out, to_string_view(glue), false, false,
+        std::begin(elements), std::end(elements));
 
-    glued_views.reserve(2 * elements.size());
-
-    for (const auto& elem : elements)
-        detail::join_stub(
-            final_strlen, glued_views, false, false, glue_view, elem);
-
-    return detail::join_stub_final(final_strlen, glued_views);
+    return out;
 }
 
 
@@ -645,16 +876,12 @@ melt_trimmed(
     const StringB& head,
     Args&&... args) noexcept
 {
-    std::vector<std::basic_string_view<Char>> glued_views;
-    std::size_t final_strlen = 0;
-    const auto glue_view = to_string_view(glue);
-
-    glued_views.reserve(2 * (1 + sizeof...(args)));  // +1 for glue_view and head
+    std::basic_string<Char> out;
 
-    detail::join_stub(
-        final_strlen, glued_views, false, true, glue_view, head, args...);
+    detail::join_append(
+        out, to_string_view(glue), false, true, head, args...);
 
-    return detail::join_stub_final(final_strlen, glued_views);
+    return out;
 }
 
 
@@ -672,20 +899,13 @@ melt_trimmed(
     const String& glue,
     const Container& elements) noexcept
 {
-    if (elements.empty())
-        return {};
-
-    std::vector<std::basic_string_view<CharA>> glued_views;
-    std::size_t final_strlen = 0;
-    const auto glue_view = to_string_view(glue);
+    std::basic_string<CharA> out;
 
-    glued_views.reserve(2 * elements.size());
+    detail::join_append_range(
+        out, to_string_view(glue), false, true,
+        std::begin(elements), std::end(elements));
 
-    for (const auto& elem : elements)
-        detail::join_stub(
-            final_strlen, glued_views, false, true, glue_view, elem);
-
-    return detail::join_stub_final(final_strlen, glued_views);
+    return out;
 }
 
 
@@ -701,12 +921,25 @@ ltrim_if(
     UnaryPredicate to_remove)
 {
     const auto inputv = to_string_view(input);
-    const auto it = std::find_if_not(inputv.begin(), inputv.end(), to_remove);
 
-    if (it == inputv.end())
-        return {};
+    if constexpr (detail::is_char_set_v<UnaryPredicate, Char>)
+    {
+        const auto pos = to_remove.find_first_not(inputv);
+        if (pos == npos)
+            return {};
+
+        return inputv.substr(pos);
+    }
+    else
+    {
+        const auto it =
+            std::find_if_not(inputv.begin(), inputv.end(), to_remove);
+
+        if (it == inputv.end())
+            return {};
 
-    return inputv.substr(std::distance(inputv.begin(), it));
+        return inputv.substr(std::distance(inputv.begin(), it));
+    }
 }
 
 
@@ -722,13 +955,25 @@ rtrim_if(
     UnaryPredicate to_remove)
 {
     const auto inputv = to_string_view(input);
-    const auto rit =
-        std::find_if_not(inputv.rbegin(), inputv.rend(), to_remove);
 
-    if (rit == inputv.rend())
-        return {};
+    if constexpr (detail::is_char_set_v<UnaryPredicate, Char>)
+    {
+        const auto pos = to_remove.find_last_not(inputv);
+        if (pos == npos)
+            return {};
 
-    return inputv.substr(0, std::distance(inputv.begin(), rit.base()));
+        return inputv.substr(0, pos + 1);
+    }
+    else
+    {
+        const auto rit =
+            std::find_if_not(inputv.rbegin(), inputv.rend(), to_remove);
+
+        if (rit == inputv.rend())
+            return {};
+
+        return inputv.substr(0, std::distance(inputv.begin(), rit.base()));
+    }
 }
 
 
@@ -805,6 +1050,36 @@ replace_all(
 }
 
 
+template <
+    typename StringA,
+    typename StringB,
+    typename Char>
+inline std::enable_if_t<
+        is_string_viewable_v<StringA> &&
+        is_string_viewable_v<StringB> &&
+        std::is_same_v<char_t<StringA>, char_t<StringB>>,
+    std::vector<size_type>>
+find_all(
+    const StringA& input_,
+    const StringB& pattern_)
+{
+    const auto input = to_string_view(input_);
+    const auto pattern = to_string_view(pattern_);
+    std::vector<size_type> out;
+
+    if (pattern.empty())
+        return out;
+
+    for (auto pos = input.find(pattern); pos != npos;
+        pos = input.find(pattern, pos + pattern.size()))
+    {
+        out.push_back(pos);
+    }
+
+    return out;
+}
+
+
 template <
     typename StringA,
     typename StringB,
@@ -823,7 +1098,7 @@ replace_all_of(
     const StringC& to_)
 {
     const auto input = to_string_view(input_);
-    const auto from_any = to_string_view(from_any_);
+    const detail::any_of<Char> from_any(to_string_view(from_any_));
     const auto to = to_string_view(to_);
 
     std::basic_string<Char> out;
@@ -838,7 +1113,7 @@ replace_all_of(
 
     do
     {
-        const auto pos = input.find_first_of(from_any, start);
+        const auto pos = from_any.find_first(input, start);
 
         if (pos != start)
         {
@@ -1006,6 +1281,95 @@ vfmt_to_n(
 }
 
 
+namespace detail
+{
+    // Convert the case of *len* characters from *src* to *dest*, which may be
+    // *src*. ASCII characters are converted directly, without the facet.
+    template <bool Upper, typename Char>
+    void convert_case(const Char* src, size_type len, Char* dest)
+    {
+        const auto& facet = cfacet<Char>;
+
+        if constexpr (sizeof(Char) == 1)
+        {
+            size_type pos = 0;
+
+            for (;;)
+            {
+                const auto* ascii_src = reinterpret_cast<const char*>(src + pos);
+                auto* ascii_dest = reinterpret_cast<char*>(dest + pos);
+
+                pos += Upper ?
+                    ascii_to_upper(ascii_src, len - pos, ascii_dest) :
+                    ascii_to_lower(ascii_src, len - pos, ascii_dest);
+
+                if (pos >= len)
+                    break;
+
+                // run of non-ASCII characters
+                auto end = pos + 1;
+                while (end < len && static_cast<std::uint8_t>(src[end]) >= 0x80)
+                    ++end;
+
+                if (dest != src)
+                    std::copy(src + pos, src + end, dest + pos);
+
+                if constexpr (Upper)
+                    facet.toupper(dest + pos, dest + end);
+                else
+                    facet.tolower(dest + pos, dest + end);
+
+                pos = end;
+            }
+        }
+        else
+        {
+            typedef std::make_unsigned_t<Char> unsigned_type;
+
+            constexpr int first = Upper ? 'a' : 'A';
+
+            for (size_type pos = 0; pos < len; ++pos)
+            {
+                const auto c = src[pos];
+
+                if (static_cast<unsigned_type>(c) >= 0x80)
+                    dest[pos] = Upper ? facet.toupper(c) : facet.tolower(c);
+                else if (static_cast<unsigned>(c - first) < 26)
+                    dest[pos] = static_cast<Char>(c ^ 0x20);
+                else
+                    dest[pos] = c;
+            }
+        }
+    }
+
+
+    template <bool Upper, typename OutputIt, typename Char>
+    OutputIt convert_case_to(OutputIt out, std::basic_string_view<Char> input)
+    {
+        if constexpr (std::is_same_v<OutputIt, Char*>)
+        {
+            convert_case<Upper>(input.data(), input.size(), out);
+            return out + input.size();
+        }
+        else
+        {
+            constexpr size_type chunk_size = 256;
+            Char chunk[chunk_size];
+
+            for (size_type pos = 0; pos < input.size(); pos += chunk_size)
+            {
+                const auto len = std::min(chunk_size, input.size() - pos);
+
+                convert_case<Upper>(input.data() + pos, len, chunk);
+                out = std::copy(chunk, chunk + len, out);
+            }
+
+            return out;
+        }
+    }
+}  // namespace detail
+
+
 template <typename Char>
 inline std::enable_if_t<is_char_v<Char>, Char>
 to_lower(Char c)
@@ -1032,14 +1396,44 @@ to_lower(const String& input_)
     if (input.empty())
         return {};
 
-    std::basic_string<Char> output(input.begin(), input.end());
+    std::basic_string<Char> output(input.size(), Char(0));
 
-    detail::cfacet<Char>.tolower(&output.front(), &output.back() + 1);
+    detail::convert_case<false>(input.data(), input.size(), output.data());
 
     return output;
 }
 
 
+template <typename Char, typename Traits, typename Alloc>
+inline std::basic_string<Char, Traits, Alloc>&
+to_lower_inplace(std::basic_string<Char, Traits, Alloc>& str)
+{
+    if (!str.empty())
+        detail::convert_case<false>(str.data(), str.size(), str.data());
+
+    return str;
+}
+
+
+template <typename Char>
+inline Char*
+to_lower_inplace(Char* str, size_type length)
+{
+    if (str && length)
+        detail::convert_case<false>(str, length, str);
+
+    return str;
+}
+
+
+template <typename OutputIt, typename String, typename Char>
+inline std::enable_if_t<is_string_viewable_v<String>, OutputIt>
+to_lower_to(OutputIt out, const String& input)
+{
+    return detail::convert_case_to<false>(out, to_string_view(input));
+}
+
+
 template <typename String, typename Char>
 inline std::enable_if_t<
     is_string_viewable_v<String>,
@@ -1050,12 +1444,42 @@ to_upper(const String& input_)
     if (input.empty())
         return {};
 
-    std::basic_string<Char> output(input.begin(), input.end());
+    std::basic_string<Char> output(input.size(), Char(0));
 
-    detail::cfacet<Char>.toupper(&output.front(), &output.back() + 1);
+    detail::convert_case<true>(input.data(), input.size(), output.data());
 
     return output;
 }
 
+
+template <typename Char, typename Traits, typename Alloc>
+inline std::basic_string<Char, Traits, Alloc>&
+to_upper_inplace(std::basic_string<Char, Traits, Alloc>& str)
+{
+    if (!str.empty())
+        detail::convert_case<true>(str.data(), str.size(), str.data());
+
+    return str;
+}
+
+
+template <typename Char>
+inline Char*
+to_upper_inplace(Char* str, size_type length)
+{
+    if (str && length)
+        detail::convert_case<true>(str, length, str);
+
+    return str;
+}
+
+
+template <typename OutputIt, typename String, typename Char>
+inline std::enable_if_t<is_string_viewable_v<String>, OutputIt>
+to_upper_to(OutputIt out, const String& input)
+{
+    return detail::convert_case_to<true>(out, to_string_view(input));
+}
+
 }  // namespace string
 }  // namespace cix
@@ -24,8 +24,30 @@ namespace cix {
 #endif
 
 
+// assumed size of a cache line, used to pad data shared between threads in
+// order to avoid false sharing
+// std::hardware_destructive_interference_size is not reliably available
+// across compilers, and has ABI implications
+static constexpr std::size_t cache_line_size = 64;
+
+
 tid_t current_thread_id() noexcept;
 pid_t current_process_id() noexcept;
 
 
+// hint the CPU that the caller is spin-waiting
+inline void cpu_relax() noexcept
+{
+    #if CIX_PLATFORM_WINDOWS
+        YieldProcessor();
+    #elif (CIX_COMPILER_GCC || CIX_COMPILER_CLANG) && (defined(__i386__) || defined(__x86_64__))
+        __builtin_ia32_pause();
+    #elif (CIX_COMPILER_GCC || CIX_COMPILER_CLANG) && (defined(__aarch64__) || defined(__arm__))
+        __asm__ __volatile__("yield");
+    #else
+        std::this_thread::yield();
+    #endif
+}
+
+
 }  // namespace cix
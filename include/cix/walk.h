@@ -0,0 +1,153 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+namespace path {
+
+// type of a directory entry, as reported by the directory listing itself
+enum class entry_type : std::uint8_t
+{
+    unknown,
+    file,
+    directory,
+    symlink,
+    other,  // device, pipe, socket, ...
+};
+
+
+struct walk_entry
+{
+    // *path* is the path of the walked root joined with the path of the entry
+    // relative to it, *name* is its basename
+    // CAUTION: both are valid during the call to the callback only
+    std::string_view path;
+    std::string_view name;
+
+    entry_type type;
+
+    // 0 for the entries of the root directory
+    unsigned depth;
+};
+
+
+struct walk_options
+{
+    // number of threads, including the calling one
+    // 0 means std::thread::hardware_concurrency()
+    unsigned threads = 0;
+
+    // directories of depth *max_depth* are not descended into, so that 0 only
+    // lists the root directory
+    unsigned max_depth = std::numeric_limits<unsigned>::max();
+
+    // follow symbolic links, which are then reported with the type of their
+    // target unless dangling, and descended into if they point to a directory
+    // (POSIX only, a directory is never listed twice)
+    bool follow_symlinks = false;
+
+    // report directories, not only the other entries
+    bool report_dirs = true;
+
+    // if set, only the entries for which *filter* returns true are reported,
+    // e.g. to match walk_entry::name against a pattern
+    std::function<bool(const walk_entry&)> filter;
+
+    // if set, only the directories for which *dir_filter* returns true are
+    // descended into, independently of *filter*
+    std::function<bool(const walk_entry&)> dir_filter;
+
+    // if set, called with the path of a directory that cannot be listed and
+    // the system error code (errno, or GetLastError() on Windows), otherwise
+    // such directories are silently skipped
+    std::function<void(std::string_view path, int error)> on_error;
+
+    // if set, the walk stops as soon as possible once *cancel* becomes true,
+    // and walk() returns without error, the remaining entries being dropped
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+
+typedef std::function<void(const walk_entry&)> walk_callback;
+
+
+// Walk the directory tree at *root* in parallel and pass each entry to
+// *callback*, in no particular order. Return once the whole tree has been
+// walked.
+//
+// Directories are listed in large batches (getdents64() on Linux, and
+// FindFirstFileEx() with FIND_FIRST_EX_LARGE_FETCH on Windows), and the type
+// of an entry is taken from the listing, so that an entry is stat'ed only
+// when the file system does not provide it. Subdirectories are spread over a
+// pool of threads that steal work from each other.
+//
+// *callback*, *filter* and *dir_filter* are called concurrently from the
+// worker threads. The first exception thrown by one of them stops the walk
+// and is rethrown by this function.
+//
+// Throws if *root* is not a directory.
+void walk(
+    std::string_view root,
+    const walk_callback& callback,
+    const walk_options& options={});
+
+
+// Same as above, except that the paths of the entries are pushed to *out*,
+// so that another thread can consume them as they come. Pushes are
+// serialized, so that *out* has a single producer at a time.
+//
+// When *out* is full, the workers back off (spin, then yield, then sleep)
+// until the consumer makes room, without holding the lock in between. Set
+// walk_options::cancel to stop a walk whose consumer went away, otherwise
+// this function does not return until every entry has been pushed.
+//
+// The end of the stream is not signaled through *out*. This function returns
+// once the last entry has been pushed, so the thread that calls it is expected
+// to notify the consumer afterwards, e.g. by setting an std::atomic<bool>
+// with release semantics, after which the consumer drains *out* one last time.
+//
+// *T* must be constructible from a std::string_view, like std::string.
+template <typename T, std::size_t N>
+void walk(
+    std::string_view root,
+    spsc_ring<T, N>& out,
+    const walk_options& options={})
+{
+    std::mutex mutex;
+
+    walk(
+        root,
+        [&out, &mutex, &options](const walk_entry& entry) {
+            T item(entry.path);
+
+            for (unsigned attempt = 0; ; ++attempt)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (out.try_push(std::move(item)))
+                        return;
+                }
+
+                if (options.cancel &&
+                    options.cancel->load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+
+                if (attempt < 64)
+                    cpu_relax();
+                else if (attempt < 128)
+                    std::this_thread::yield();
+                else
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        },
+        options);
+}
+
+}  // namespace path
+}  // namespace cix
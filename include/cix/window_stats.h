@@ -0,0 +1,380 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "detail/ensure_cix.h"
+
+namespace cix {
+
+// Statistics over a sliding window of the last *N* samples, typically
+// latencies.
+//
+// Aggregates are maintained incrementally as samples are pushed, so that
+// querying them does not require to iterate over the whole window:
+// * sum, mean, variance: O(1), updated with Welford's method
+// * min, max: O(1), amortized O(1) push with monotonic deques
+// * percentiles: O(log N), with an order-statistic treap of the samples
+//
+// All storage is allocated by the constructor. push() does not allocate.
+//
+// CAUTION: NaN samples are not supported
+template <typename T, std::size_t N>
+class window_stats
+{
+public:
+    typedef std::size_t size_type;
+    typedef T value_type;
+
+    // exact for integral samples
+    typedef std::conditional_t<
+        std::is_integral_v<T>,
+        std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>,
+        double> sum_type;
+
+    static_assert(std::is_arithmetic_v<T>);
+    static_assert(N > 0 && N < std::numeric_limits<std::uint32_t>::max());
+
+public:
+    window_stats()
+        : m_nodes(N)
+        , m_root{nil}
+        , m_seq{0}
+        , m_size{0}
+        , m_sum{0}
+        , m_mean{0.0}
+        , m_m2{0.0}
+        , m_rng{0x9e3779b9u}
+        { }
+
+    ~window_stats() = default;
+
+    static constexpr size_type capacity() noexcept { return N; }
+    size_type size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+    bool full() const noexcept { return m_size == N; }
+
+    void clear() noexcept
+    {
+        m_min_seqs.clear();
+        m_max_seqs.clear();
+        m_root = nil;
+        m_seq = 0;
+        m_size = 0;
+        m_sum = 0;
+        m_mean = 0.0;
+        m_m2 = 0.0;
+    }
+
+    // push a sample, drop the oldest one if window is full
+    void push(value_type sample)
+    {
+        if (m_size == N)
+            this->evict_oldest();
+
+        const auto slot = this->slot_of(m_seq);
+        auto& node = m_nodes[slot];
+
+        node.value = sample;
+        node.seq = m_seq;
+        node.priority = this->next_priority();
+        node.size = 1;
+        node.left = nil;
+        node.right = nil;
+
+        m_root = this->insert(m_root, slot);
+
+        // monotonic deques: front is the min (max) of the window, and the
+        // samples that can never become min (max) are dropped from the back
+        while (!m_min_seqs.empty() && !(this->value_of(m_min_seqs.back()) < sample))
+            m_min_seqs.pop_back();
+        m_min_seqs.push_back(m_seq);
+
+        while (!m_max_seqs.empty() && !(sample < this->value_of(m_max_seqs.back())))
+            m_max_seqs.pop_back();
+        m_max_seqs.push_back(m_seq);
+
+        ++m_seq;
+        ++m_size;
+
+        const auto x = static_cast<double>(sample);
+        const auto delta = x - m_mean;
+
+        m_sum += static_cast<sum_type>(sample);
+        m_mean += delta / static_cast<double>(m_size);
+        m_m2 += delta * (x - m_mean);
+    }
+
+    sum_type sum() const noexcept
+    {
+        return m_sum;
+    }
+
+    double mean() const noexcept
+    {
+        return m_mean;
+    }
+
+    // population variance
+    double variance() const noexcept
+    {
+        return m_size ? std::max(0.0, m_m2 / static_cast<double>(m_size)) : 0.0;
+    }
+
+    double stddev() const noexcept
+    {
+        return std::sqrt(this->variance());
+    }
+
+    value_type min() const noexcept
+    {
+        assert(!this->empty());
+        return this->empty() ? value_type{} : this->value_of(m_min_seqs.front());
+    }
+
+    value_type max() const noexcept
+    {
+        assert(!this->empty());
+        return this->empty() ? value_type{} : this->value_of(m_max_seqs.front());
+    }
+
+    // nearest-rank percentile, *pct* in range [0, 100]
+    value_type percentile(double pct) const noexcept
+    {
+        assert(!this->empty());
+        assert(pct >= 0.0 && pct <= 100.0);
+        if (this->empty())
+            return value_type{};
+
+        const auto rank = std::ceil(pct / 100.0 * static_cast<double>(m_size));
+        const auto idx =
+            (rank <= 1.0) ? size_type{0} :
+            (rank >= static_cast<double>(m_size)) ? m_size - 1 :
+            static_cast<size_type>(rank) - 1;
+
+        return this->nth(idx);
+    }
+
+    value_type median() const noexcept
+    {
+        return this->percentile(50.0);
+    }
+
+    // *idx*-th smallest sample
+    value_type nth(size_type idx) const noexcept
+    {
+        assert(idx < m_size);
+
+        auto node = m_root;
+        for (;;)
+        {
+            const auto& n = m_nodes[node];
+            const auto left_size = this->size_of(n.left);
+
+            if (idx < left_size)
+            {
+                node = n.left;
+            }
+            else if (idx == left_size)
+            {
+                return n.value;
+            }
+            else
+            {
+                idx -= left_size + 1;
+                node = n.right;
+            }
+        }
+    }
+
+
+private:
+    typedef std::uint32_t index_type;
+
+    static constexpr index_type nil = std::numeric_limits<index_type>::max();
+
+    // node of the treap, ordered by (value, seq) so that keys are unique
+    struct node_t
+    {
+        value_type value;
+        std::uint64_t seq;
+        std::uint32_t priority;
+        index_type size;  // of the subtree
+        index_type left;
+        index_type right;
+    };
+
+    // the sample of sequence number *seq* always lives in the same node
+    static index_type slot_of(std::uint64_t seq) noexcept
+    {
+        return static_cast<index_type>(seq % N);
+    }
+
+    value_type value_of(std::uint64_t seq) const noexcept
+    {
+        return m_nodes[slot_of(seq)].value;
+    }
+
+    index_type size_of(index_type node) const noexcept
+    {
+        return (node == nil) ? 0 : m_nodes[node].size;
+    }
+
+    void update_size(index_type node) noexcept
+    {
+        auto& n = m_nodes[node];
+        n.size = 1 + this->size_of(n.left) + this->size_of(n.right);
+    }
+
+    bool less(index_type a, index_type b) const noexcept
+    {
+        const auto& na = m_nodes[a];
+        const auto& nb = m_nodes[b];
+        return
+            (na.value < nb.value) ||
+            (!(nb.value < na.value) && na.seq < nb.seq);
+    }
+
+    // xorshift32
+    std::uint32_t next_priority() noexcept
+    {
+        m_rng ^= m_rng << 13;
+        m_rng ^= m_rng >> 17;
+        m_rng ^= m_rng << 5;
+        return m_rng;
+    }
+
+    void evict_oldest() noexcept
+    {
+        assert(m_size > 0);
+
+        const auto seq = m_seq - m_size;
+        const auto slot = this->slot_of(seq);
+        const auto sample = m_nodes[slot].value;
+
+        m_root = this->erase(m_root, slot);
+
+        if (m_min_seqs.front() == seq)
+            m_min_seqs.pop_front();
+        if (m_max_seqs.front() == seq)
+            m_max_seqs.pop_front();
+
+        --m_size;
+
+        m_sum -= static_cast<sum_type>(sample);
+
+        if (!m_size)
+        {
+            m_mean = 0.0;
+            m_m2 = 0.0;
+        }
+        else
+        {
+            const auto x = static_cast<double>(sample);
+            const auto delta = x - m_mean;
+
+            m_mean -= delta / static_cast<double>(m_size);
+            m_m2 -= delta * (x - m_mean);
+        }
+    }
+
+    // split subtree *node* into nodes ordered before *key* (left) and the
+    // others (right)
+    void split(
+        index_type node, index_type key,
+        index_type& left, index_type& right) noexcept
+    {
+        if (node == nil)
+        {
+            left = nil;
+            right = nil;
+        }
+        else if (this->less(node, key))
+        {
+            this->split(m_nodes[node].right, key, m_nodes[node].right, right);
+            left = node;
+            this->update_size(node);
+        }
+        else
+        {
+            this->split(m_nodes[node].left, key, left, m_nodes[node].left);
+            right = node;
+            this->update_size(node);
+        }
+    }
+
+    // all the nodes of *left* must be ordered before the ones of *right*
+    index_type merge(index_type left, index_type right) noexcept
+    {
+        if (left == nil)
+            return right;
+        if (right == nil)
+            return left;
+
+        if (m_nodes[left].priority > m_nodes[right].priority)
+        {
+            m_nodes[left].right = this->merge(m_nodes[left].right, right);
+            this->update_size(left);
+            return left;
+        }
+        else
+        {
+            m_nodes[right].left = this->merge(left, m_nodes[right].left);
+            this->update_size(right);
+            return right;
+        }
+    }
+
+    index_type insert(index_type node, index_type key) noexcept
+    {
+        if (node == nil)
+            return key;
+
+        if (m_nodes[key].priority > m_nodes[node].priority)
+        {
+            this->split(node, key, m_nodes[key].left, m_nodes[key].right);
+            this->update_size(key);
+            return key;
+        }
+
+        if (this->less(key, node))
+            m_nodes[node].left = this->insert(m_nodes[node].left, key);
+        else
+            m_nodes[node].right = this->insert(m_nodes[node].right, key);
+
+        this->update_size(node);
+        return node;
+    }
+
+    index_type erase(index_type node, index_type key) noexcept
+    {
+        assert(node != nil);
+
+        if (node == key)
+            return this->merge(m_nodes[node].left, m_nodes[node].right);
+
+        if (this->less(key, node))
+            m_nodes[node].left = this->erase(m_nodes[node].left, key);
+        else
+            m_nodes[node].right = this->erase(m_nodes[node].right, key);
+
+        this->update_size(node);
+        return node;
+    }
+
+
+private:
+    std::vector<node_t> m_nodes;
+    index_type m_root;
+    circular_vector<std::uint64_t, N> m_min_seqs;
+    circular_vector<std::uint64_t, N> m_max_seqs;
+    std::uint64_t m_seq;  // number of samples pushed since clear()
+    size_type m_size;
+    sum_type m_sum;
+    double m_mean;
+    double m_m2;  // sum of squared deviations from the mean
+    std::uint32_t m_rng;
+};
+
+}  // namespace cix
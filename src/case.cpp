@@ -0,0 +1,284 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+namespace string {
+
+namespace detail::ascii_case
+{
+    // Convert the letters in [*first*, *first* + 25] of the ASCII bytes at
+    // *src* to *dest*, by flipping their 0x20 bit, up to the first non-ASCII
+    // byte. Return the number of bytes converted.
+    size_type convert(
+        const char* src_, size_type len, char* dest_, char first) noexcept
+    {
+        const auto* src = reinterpret_cast<const std::uint8_t*>(src_);
+        auto* dest = reinterpret_cast<std::uint8_t*>(dest_);
+        size_type pos = 0;
+
+        // bytes are signed, which is fine since only ASCII blocks are
+        // converted
+    #if CIX_HAS_AVX2
+        {
+            const auto lower_bound = _mm256_set1_epi8(static_cast<char>(first - 1));
+            const auto upper_bound = _mm256_set1_epi8(static_cast<char>(first + 26));
+            const auto flip = _mm256_set1_epi8(0x20);
+
+            for (; pos + 32 <= len; pos += 32)
+            {
+                const auto block = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(src + pos));
+
+                if (_mm256_movemask_epi8(block))
+                    break;
+
+                const auto letters = _mm256_and_si256(
+                    _mm256_cmpgt_epi8(block, lower_bound),
+                    _mm256_cmpgt_epi8(upper_bound, block));
+
+                _mm256_storeu_si256(
+                    reinterpret_cast<__m256i*>(dest + pos),
+                    _mm256_xor_si256(block, _mm256_and_si256(letters, flip)));
+            }
+        }
+    #endif
+
+    #if CIX_HAS_SSE2
+        {
+            const auto lower_bound = _mm_set1_epi8(static_cast<char>(first - 1));
+            const auto upper_bound = _mm_set1_epi8(static_cast<char>(first + 26));
+            const auto flip = _mm_set1_epi8(0x20);
+
+            for (; pos + 16 <= len; pos += 16)
+            {
+                const auto block = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + pos));
+
+                if (_mm_movemask_epi8(block))
+                    break;
+
+                const auto letters = _mm_and_si128(
+                    _mm_cmpgt_epi8(block, lower_bound),
+                    _mm_cmpgt_epi8(upper_bound, block));
+
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(dest + pos),
+                    _mm_xor_si128(block, _mm_and_si128(letters, flip)));
+            }
+        }
+    #else
+        {
+            // the high bit of each byte of a word is set by the additions
+            // below if the byte is >= first, and > first + 25 respectively,
+            // without carry since bytes are ASCII
+            const std::uint64_t ones = 0x0101010101010101ull;
+            const std::uint64_t high_bits = 0x8080808080808080ull;
+            const auto ge_first = ones * static_cast<std::uint8_t>(0x80 - first);
+            const auto gt_last = ones * static_cast<std::uint8_t>(0x80 - first - 26);
+
+            for (; pos + 8 <= len; pos += 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, src + pos, sizeof(word));
+
+                if (word & high_bits)
+                    break;
+
+                const auto letters = ((word + ge_first) ^ (word + gt_last)) & high_bits;
+
+                word ^= letters >> 2;
+                std::memcpy(dest + pos, &word, sizeof(word));
+            }
+        }
+    #endif
+
+        for (; pos < len; ++pos)
+        {
+            const auto c = src[pos];
+
+            if (c >= 0x80)
+                break;
+
+            const bool letter = static_cast<std::uint8_t>(c - first) < 26;
+            dest[pos] = letter ? static_cast<std::uint8_t>(c ^ 0x20) : c;
+        }
+
+        return pos;
+    }
+
+
+    using cix::detail::lowest_bit;
+
+
+    inline std::uint8_t fold(char c) noexcept
+    {
+        const auto b = static_cast<std::uint8_t>(c);
+        return (static_cast<std::uint8_t>(b - 'A') < 26) ? (b | 0x20) : b;
+    }
+
+
+    // fold the ASCII letters of a word of 8 bytes to lower case, leaving other
+    // bytes untouched
+    inline std::uint64_t fold(std::uint64_t word) noexcept
+    {
+        const std::uint64_t ones = 0x0101010101010101ull;
+        const std::uint64_t high_bits = 0x8080808080808080ull;
+        const auto low = word & ~high_bits;
+        const auto upper =
+            ((low + ones * (0x80 - 'A')) ^ (low + ones * (0x80 - 'Z' - 1))) &
+            ~word & high_bits;
+
+        return word | (upper >> 2);
+    }
+
+
+    // Return the index of the first character that differs between *a* and
+    // *b* once ASCII letters are folded, or *len*.
+    //
+    // Signed bytes are fine here since non-ASCII ones are negative, so they
+    // never fall in the range of letters.
+    size_type mismatch(const char* a, const char* b, size_type len) noexcept
+    {
+        size_type pos = 0;
+
+    #if CIX_HAS_AVX2
+        {
+            const auto lower_bound = _mm256_set1_epi8('A' - 1);
+            const auto upper_bound = _mm256_set1_epi8('Z' + 1);
+            const auto flip = _mm256_set1_epi8(0x20);
+
+            const auto fold_block = [&](__m256i block) {
+                return _mm256_or_si256(block, _mm256_and_si256(flip,
+                    _mm256_and_si256(
+                        _mm256_cmpgt_epi8(block, lower_bound),
+                        _mm256_cmpgt_epi8(upper_bound, block))));
+            };
+
+            for (; pos + 32 <= len; pos += 32)
+            {
+                const auto block_a = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(a + pos));
+                const auto block_b = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(b + pos));
+
+                const auto equal = static_cast<std::uint32_t>(
+                    _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                        fold_block(block_a), fold_block(block_b))));
+
+                if (equal != 0xffffffffu)
+                    return pos + lowest_bit(~equal);
+            }
+        }
+    #endif
+
+    #if CIX_HAS_SSE2
+        {
+            const auto lower_bound = _mm_set1_epi8('A' - 1);
+            const auto upper_bound = _mm_set1_epi8('Z' + 1);
+            const auto flip = _mm_set1_epi8(0x20);
+
+            const auto fold_block = [&](__m128i block) {
+                return _mm_or_si128(block, _mm_and_si128(flip,
+                    _mm_and_si128(
+                        _mm_cmpgt_epi8(block, lower_bound),
+                        _mm_cmpgt_epi8(upper_bound, block))));
+            };
+
+            for (; pos + 16 <= len; pos += 16)
+            {
+                const auto block_a = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(a + pos));
+                const auto block_b = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(b + pos));
+
+                const auto equal = static_cast<std::uint32_t>(
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(
+                        fold_block(block_a), fold_block(block_b))));
+
+                if (equal != 0xffffu)
+                    return pos + lowest_bit(~equal);
+            }
+        }
+    #else
+        for (; pos + 8 <= len; pos += 8)
+        {
+            std::uint64_t word_a, word_b;
+            std::memcpy(&word_a, a + pos, sizeof(word_a));
+            std::memcpy(&word_b, b + pos, sizeof(word_b));
+
+            if (fold(word_a) != fold(word_b))
+                break;
+        }
+    #endif
+
+        for (; pos < len; ++pos)
+        {
+            if (fold(a[pos]) != fold(b[pos]))
+                break;
+        }
+
+        return pos;
+    }
+
+
+    // see cix::detail::fx_hash()
+    std::uint64_t hash(const char* s, size_type len) noexcept
+    {
+        return cix::detail::fx_hash(s, len, [](std::uint64_t word) {
+            return fold(word);
+        });
+    }
+}  // namespace detail::ascii_case
+
+
+namespace detail
+{
+    size_type ascii_to_lower(const char* src, size_type len, char* dest) noexcept
+    {
+        return ascii_case::convert(src, len, dest, 'A');
+    }
+
+
+    size_type ascii_to_upper(const char* src, size_type len, char* dest) noexcept
+    {
+        return ascii_case::convert(src, len, dest, 'a');
+    }
+}  // namespace detail
+
+
+bool iequals(std::string_view a, std::string_view b) noexcept
+{
+    return
+        a.size() == b.size() &&
+        detail::ascii_case::mismatch(a.data(), b.data(), a.size()) == a.size();
+}
+
+
+int icompare(std::string_view a, std::string_view b) noexcept
+{
+    const auto len = std::min(a.size(), b.size());
+    const auto pos = detail::ascii_case::mismatch(a.data(), b.data(), len);
+
+    if (pos < len)
+    {
+        return
+            (detail::ascii_case::fold(a[pos]) < detail::ascii_case::fold(b[pos])) ?
+            -1 : 1;
+    }
+
+    return (a.size() < b.size()) ? -1 : (a.size() > b.size()) ? 1 : 0;
+}
+
+
+std::size_t ihash(std::string_view input) noexcept
+{
+    return static_cast<std::size_t>(
+        detail::ascii_case::hash(input.data(), input.size()));
+}
+
+}  // namespace string
+}  // namespace cix
@@ -0,0 +1,345 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+
+namespace detail::char_set
+{
+    typedef cix::char_set::size_type size_type;
+
+    static constexpr auto npos = cix::char_set::npos;
+
+    using cix::detail::lowest_bit;
+    using cix::detail::highest_bit;
+
+
+    // the set as seen by the search loops below
+    struct table_t
+    {
+        const std::uint8_t* table;  // 32 bytes, see char_set::index_of()
+        const std::uint8_t* chars;  // first max_small characters
+        std::uint8_t small;         // number of characters, or max_small + 1
+
+        bool contains(std::uint8_t b) const noexcept
+        {
+            const auto idx = (b & 0x0f) | ((b >> 3) & 0x10);
+            const auto bit = 1u << ((b >> 4) & 0x07);
+            return (this->table[idx] & bit) != 0;
+        }
+    };
+
+
+#if CIX_HAS_AVX2
+    // Classify 32 bytes at once: the table of the half a byte belongs to is
+    // looked up with its low nibble, then the bit to test is selected by its
+    // high nibble. pshufb zeroes the result of an index with its high bit
+    // set, so each half of the table only answers for its own bytes.
+    class kernel32
+    {
+    public:
+        explicit kernel32(const table_t& set) noexcept
+            : m_lo{_mm256_broadcastsi128_si256(
+                _mm_load_si128(reinterpret_cast<const __m128i*>(set.table)))}
+            , m_hi{_mm256_broadcastsi128_si256(
+                _mm_load_si128(reinterpret_cast<const __m128i*>(set.table + 16)))}
+            , m_bits{_mm256_setr_epi8(
+                1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128)}
+            , m_nibble{_mm256_set1_epi8(0x0f)}
+            , m_flip{_mm256_set1_epi8(-128)}
+            { }
+
+        // one bit per byte of *p* that belongs to the set
+        std::uint32_t match(const std::uint8_t* p) const noexcept
+        {
+            const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const auto t = _mm256_or_si256(
+                _mm256_shuffle_epi8(m_lo, v),
+                _mm256_shuffle_epi8(m_hi, _mm256_xor_si256(v, m_flip)));
+            const auto b = _mm256_shuffle_epi8(
+                m_bits, _mm256_and_si256(_mm256_srli_epi16(v, 4), m_nibble));
+            const auto z = _mm256_cmpeq_epi8(
+                _mm256_and_si256(t, b), _mm256_setzero_si256());
+
+            return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(z));
+        }
+
+    private:
+        const __m256i m_lo;
+        const __m256i m_hi;
+        const __m256i m_bits;
+        const __m256i m_nibble;
+        const __m256i m_flip;
+    };
+#endif  // #if CIX_HAS_AVX2
+
+
+#if CIX_HAS_SSSE3
+    // 16-byte version of kernel32
+    class kernel16
+    {
+    public:
+        explicit kernel16(const table_t& set) noexcept
+            : m_lo{_mm_load_si128(reinterpret_cast<const __m128i*>(set.table))}
+            , m_hi{_mm_load_si128(reinterpret_cast<const __m128i*>(set.table + 16))}
+            , m_bits{_mm_setr_epi8(
+                1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128)}
+            , m_nibble{_mm_set1_epi8(0x0f)}
+            , m_flip{_mm_set1_epi8(-128)}
+            { }
+
+        static bool supports(const table_t&) noexcept { return true; }
+
+        std::uint32_t match(const std::uint8_t* p) const noexcept
+        {
+            const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const auto t = _mm_or_si128(
+                _mm_shuffle_epi8(m_lo, v),
+                _mm_shuffle_epi8(m_hi, _mm_xor_si128(v, m_flip)));
+            const auto b = _mm_shuffle_epi8(
+                m_bits, _mm_and_si128(_mm_srli_epi16(v, 4), m_nibble));
+            const auto z = _mm_cmpeq_epi8(_mm_and_si128(t, b), _mm_setzero_si128());
+
+            return ~static_cast<std::uint32_t>(_mm_movemask_epi8(z)) & 0xffff;
+        }
+
+    private:
+        const __m128i m_lo;
+        const __m128i m_hi;
+        const __m128i m_bits;
+        const __m128i m_nibble;
+        const __m128i m_flip;
+    };
+#elif CIX_HAS_SSE2
+    // no pshufb: compare input with each character of a small set
+    class kernel16
+    {
+    public:
+        explicit kernel16(const table_t& set) noexcept
+            : m_c0{_mm_set1_epi8(static_cast<char>(set.chars[0]))}
+            , m_c1{_mm_set1_epi8(static_cast<char>(set.chars[set.small > 1 ? 1 : 0]))}
+            , m_c2{_mm_set1_epi8(static_cast<char>(set.chars[set.small > 2 ? 2 : 0]))}
+            , m_c3{_mm_set1_epi8(static_cast<char>(set.chars[set.small > 3 ? 3 : 0]))}
+            { }
+
+        static bool supports(const table_t& set) noexcept
+        {
+            return set.small <= cix::char_set::max_small;
+        }
+
+        std::uint32_t match(const std::uint8_t* p) const noexcept
+        {
+            const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const auto m = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, m_c0), _mm_cmpeq_epi8(v, m_c1)),
+                _mm_or_si128(_mm_cmpeq_epi8(v, m_c2), _mm_cmpeq_epi8(v, m_c3)));
+
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(m));
+        }
+
+    private:
+        const __m128i m_c0;
+        const __m128i m_c1;
+        const __m128i m_c2;
+        const __m128i m_c3;
+    };
+#endif
+
+
+    template <bool Negate>
+    size_type find_first(
+        const table_t& set,
+        const std::uint8_t* p,
+        size_type size) noexcept
+    {
+        size_type idx = 0;
+
+    #if CIX_HAS_AVX2
+        if (size >= 32)
+        {
+            const kernel32 kernel(set);
+
+            for (; idx + 64 <= size; idx += 64)
+            {
+                auto mask =
+                    std::uint64_t{kernel.match(p + idx)} |
+                    (std::uint64_t{kernel.match(p + idx + 32)} << 32);
+
+                if constexpr (Negate)
+                    mask = ~mask;
+
+                if (mask)
+                    return idx + lowest_bit(mask);
+            }
+
+            for (; idx + 32 <= size; idx += 32)
+            {
+                auto mask = kernel.match(p + idx);
+
+                if constexpr (Negate)
+                    mask = ~mask;
+
+                if (mask)
+                    return idx + lowest_bit(mask);
+            }
+        }
+    #endif
+
+    #if CIX_HAS_SSSE3 || CIX_HAS_SSE2
+        if (size - idx >= 16 && kernel16::supports(set))
+        {
+            const kernel16 kernel(set);
+
+            for (; idx + 16 <= size; idx += 16)
+            {
+                auto mask = kernel.match(p + idx);
+
+                if constexpr (Negate)
+                    mask = ~mask & 0xffff;
+
+                if (mask)
+                    return idx + lowest_bit(mask);
+            }
+        }
+    #endif
+
+        for (; idx < size; ++idx)
+        {
+            if (set.contains(p[idx]) != Negate)
+                return idx;
+        }
+
+        return npos;
+    }
+
+
+    template <bool Negate>
+    size_type find_last(
+        const table_t& set,
+        const std::uint8_t* p,
+        size_type size) noexcept
+    {
+        size_type idx = size;
+
+    #if CIX_HAS_AVX2
+        if (size >= 32)
+        {
+            const kernel32 kernel(set);
+
+            for (; idx >= 64; idx -= 64)
+            {
+                auto mask =
+                    std::uint64_t{kernel.match(p + idx - 64)} |
+                    (std::uint64_t{kernel.match(p + idx - 32)} << 32);
+
+                if constexpr (Negate)
+                    mask = ~mask;
+
+                if (mask)
+                    return idx - 64 + highest_bit(mask);
+            }
+
+            for (; idx >= 32; idx -= 32)
+            {
+                auto mask = kernel.match(p + idx - 32);
+
+                if constexpr (Negate)
+                    mask = ~mask;
+
+                if (mask)
+                    return idx - 32 + highest_bit(mask);
+            }
+        }
+    #endif
+
+    #if CIX_HAS_SSSE3 || CIX_HAS_SSE2
+        if (idx >= 16 && kernel16::supports(set))
+        {
+            const kernel16 kernel(set);
+
+            for (; idx >= 16; idx -= 16)
+            {
+                auto mask = kernel.match(p + idx - 16);
+
+                if constexpr (Negate)
+                    mask = ~mask & 0xffff;
+
+                if (mask)
+                    return idx - 16 + highest_bit(mask);
+            }
+        }
+    #endif
+
+        while (idx-- > 0)
+        {
+            if (set.contains(p[idx]) != Negate)
+                return idx;
+        }
+
+        return npos;
+    }
+}  // namespace detail::char_set
+
+
+char_set::size_type
+char_set::find_first(const void* data, size_type size) const noexcept
+{
+    if (!size || this->empty())
+        return npos;
+
+    return detail::char_set::find_first<false>(
+        { m_table, m_chars, m_small },
+        static_cast<const std::uint8_t*>(data),
+        size);
+}
+
+
+char_set::size_type
+char_set::find_first_not(const void* data, size_type size) const noexcept
+{
+    if (!size)
+        return npos;
+
+    if (this->empty())
+        return 0;
+
+    return detail::char_set::find_first<true>(
+        { m_table, m_chars, m_small },
+        static_cast<const std::uint8_t*>(data),
+        size);
+}
+
+
+char_set::size_type
+char_set::find_last(const void* data, size_type size) const noexcept
+{
+    if (!size || this->empty())
+        return npos;
+
+    return detail::char_set::find_last<false>(
+        { m_table, m_chars, m_small },
+        static_cast<const std::uint8_t*>(data),
+        size);
+}
+
+
+char_set::size_type
+char_set::find_last_not(const void* data, size_type size) const noexcept
+{
+    if (!size)
+        return npos;
+
+    if (this->empty())
+        return size - 1;
+
+    return detail::char_set::find_last<true>(
+        { m_table, m_chars, m_small },
+        static_cast<const std::uint8_t*>(data),
+        size);
+}
+
+}  // namespace cix
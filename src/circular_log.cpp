@@ -0,0 +1,576 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+
+namespace detail::circular_log
+{
+    typedef cix::circular_log::size_type size_type;
+
+    static constexpr char file_magic[8] = {
+        'C', 'I', 'X', 'C', 'L', 'O', 'G', '\0' };
+    static constexpr std::uint32_t file_version = 1;
+
+    struct header_t
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t header_size;
+        std::uint64_t capacity;   // size of data area
+        std::uint64_t cursor;     // offset of next record in data area
+        std::uint64_t loops;      // number of times cursor went back to zero
+        std::uint64_t next_seq;
+        std::uint8_t reserved[16];
+    };
+
+    static_assert(sizeof(header_t) == cix::circular_log::header_size);
+
+
+    // a read-write or read-only, shared mapping of a whole file
+    class file_mapping
+    {
+    public:
+        CIX_NONCOPYABLE(file_mapping)
+
+        // if *writable*, file is created if needed and resized to *size*
+        file_mapping(const std::string& path, bool writable, std::uint64_t size)
+            #if CIX_PLATFORM_WINDOWS
+            : m_file{INVALID_HANDLE_VALUE}
+            , m_mapping{nullptr}
+            #else
+            : m_fd{-1}
+            #endif
+            , m_data{nullptr}
+            , m_size{0}
+        {
+            try
+            {
+                this->open(path, writable, size);
+            }
+            catch (...)
+            {
+                this->close();
+                throw;
+            }
+        }
+
+        ~file_mapping()
+        {
+            this->close();
+        }
+
+        std::uint8_t* data() const noexcept { return m_data; }
+        std::uint64_t size() const noexcept { return m_size; }
+
+        void flush(bool async)
+        {
+            #if CIX_PLATFORM_WINDOWS
+                if (!FlushViewOfFile(m_data, 0))
+                    CIX_THROW_WINERR("circular_log: failed to flush view ({} bytes)", m_size);
+                if (!async && !FlushFileBuffers(m_file))
+                    CIX_THROW_WINERR("circular_log: failed to flush file ({} bytes)", m_size);
+            #else
+                if (0 != msync(m_data, m_size, async ? MS_ASYNC : MS_SYNC))
+                    CIX_THROW_CRTERR("circular_log: msync failed ({} bytes)", m_size);
+            #endif
+        }
+
+    private:
+        void open(const std::string& path, bool writable, std::uint64_t size)
+        {
+            #if CIX_PLATFORM_WINDOWS
+                m_file = CreateFileW(
+                    string::u8tow(path).c_str(),
+                    writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                    FILE_SHARE_READ | FILE_SHARE_WRITE,
+                    nullptr,
+                    writable ? OPEN_ALWAYS : OPEN_EXISTING,
+                    FILE_ATTRIBUTE_NORMAL,
+                    nullptr);
+                if (m_file == INVALID_HANDLE_VALUE)
+                    CIX_THROW_WINERR("circular_log: failed to open {}", path);
+
+                if (writable)
+                {
+                    LARGE_INTEGER li;
+                    li.QuadPart = static_cast<LONGLONG>(size);
+                    if (!SetFilePointerEx(m_file, li, nullptr, FILE_BEGIN) ||
+                        !SetEndOfFile(m_file))
+                    {
+                        CIX_THROW_WINERR("circular_log: failed to resize {}", path);
+                    }
+                }
+                else
+                {
+                    LARGE_INTEGER li;
+                    if (!GetFileSizeEx(m_file, &li))
+                        CIX_THROW_WINERR("circular_log: failed to get size of {}", path);
+                    size = static_cast<std::uint64_t>(li.QuadPart);
+                }
+
+                if (!size)
+                    CIX_THROW_RUNTIME("circular_log: empty file {}", path);
+
+                m_mapping = CreateFileMappingW(
+                    m_file, nullptr,
+                    writable ? PAGE_READWRITE : PAGE_READONLY,
+                    0, 0, nullptr);
+                if (!m_mapping)
+                    CIX_THROW_WINERR("circular_log: failed to create mapping of {}", path);
+
+                m_data = reinterpret_cast<std::uint8_t*>(MapViewOfFile(
+                    m_mapping,
+                    writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+                    0, 0, 0));
+                if (!m_data)
+                    CIX_THROW_WINERR("circular_log: failed to map {}", path);
+            #else
+                m_fd = ::open(
+                    path.c_str(),
+                    writable ? (O_RDWR | O_CREAT | O_CLOEXEC) : (O_RDONLY | O_CLOEXEC),
+                    S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                if (m_fd < 0)
+                    CIX_THROW_CRTERR("circular_log: failed to open {}", path);
+
+                if (writable)
+                {
+                    if (0 != ftruncate(m_fd, static_cast<off_t>(size)))
+                        CIX_THROW_CRTERR("circular_log: failed to resize {}", path);
+                }
+                else
+                {
+                    struct stat st;
+                    if (0 != fstat(m_fd, &st))
+                        CIX_THROW_CRTERR("circular_log: failed to stat {}", path);
+                    size = static_cast<std::uint64_t>(st.st_size);
+                }
+
+                if (!size)
+                    CIX_THROW_RUNTIME("circular_log: empty file {}", path);
+
+                void* addr = mmap(
+                    nullptr, static_cast<std::size_t>(size),
+                    writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                    MAP_SHARED, m_fd, 0);
+                if (addr == MAP_FAILED)
+                    CIX_THROW_CRTERR("circular_log: failed to map {}", path);
+
+                m_data = reinterpret_cast<std::uint8_t*>(addr);
+            #endif
+
+            m_size = size;
+        }
+
+        void close() noexcept
+        {
+            #if CIX_PLATFORM_WINDOWS
+                if (m_data)
+                    UnmapViewOfFile(m_data);
+                if (m_mapping)
+                    CloseHandle(m_mapping);
+                if (m_file != INVALID_HANDLE_VALUE)
+                    CloseHandle(m_file);
+                m_file = INVALID_HANDLE_VALUE;
+                m_mapping = nullptr;
+            #else
+                if (m_data)
+                    munmap(m_data, static_cast<std::size_t>(m_size));
+                if (m_fd >= 0)
+                    ::close(m_fd);
+                m_fd = -1;
+            #endif
+
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+    private:
+        #if CIX_PLATFORM_WINDOWS
+            HANDLE m_file;
+            HANDLE m_mapping;
+        #else
+            int m_fd;
+        #endif
+        std::uint8_t* m_data;
+        std::uint64_t m_size;
+    };
+
+
+    inline header_t* header_of(std::uint8_t* data) noexcept
+    {
+        return reinterpret_cast<header_t*>(data);
+    }
+
+
+    inline const header_t* header_of(const std::uint8_t* data) noexcept
+    {
+        return reinterpret_cast<const header_t*>(data);
+    }
+
+
+    inline bool is_header_valid(const header_t& header, std::uint64_t file_size)
+    {
+        return
+            0 == std::memcmp(header.magic, file_magic, sizeof(file_magic)) &&
+            header.version == file_version &&
+            header.header_size == sizeof(header_t) &&
+            header.capacity + sizeof(header_t) == file_size &&
+            header.cursor <= header.capacity &&
+            header.cursor % cix::circular_log::record_alignment == 0;
+    }
+
+
+    // parse the record at *pos* in the data area of *capacity* bytes, return
+    // its frame size, or 0 if not valid
+    inline size_type parse_record(
+        const std::uint8_t* area, size_type capacity, size_type pos,
+        cix::circular_log_reader::entry& out)
+    {
+        using cix::circular_log;
+
+        if (capacity - pos < circular_log::record_header_size)
+            return 0;
+
+        const auto* const p = area + pos;
+
+        std::uint32_t magic, crc, size;
+        std::uint64_t seq;
+
+        std::memcpy(&magic, p, sizeof(magic));
+        std::memcpy(&crc, p + 4, sizeof(crc));
+        std::memcpy(&seq, p + 8, sizeof(seq));
+        std::memcpy(&size, p + 16, sizeof(size));
+
+        if (magic != circular_log::record_magic ||
+            size > capacity - circular_log::record_header_size)
+        {
+            return 0;
+        }
+
+        const auto frame_size = circular_log::frame_size(size);
+        if (frame_size > capacity - pos)
+            return 0;
+
+        if (crc != crc32::crc32(p + 8, circular_log::record_header_size - 8 + size))
+            return 0;
+
+        out.seq = seq;
+        out.payload.data = p + circular_log::record_header_size;
+        out.payload.size = size;
+
+        return frame_size;
+    }
+
+
+    // Walk the zero padding and the frames left by the previous loop from
+    // *pos*, which is always at a frame boundary, and return the end of the
+    // last one that starts before *end*. Only the magic and the size of the
+    // frames are checked, this is not meant to validate them.
+    inline size_type end_of_overwritten(
+        const std::uint8_t* area, size_type capacity, size_type pos, size_type end)
+    {
+        using cix::circular_log;
+
+        while (pos < end)
+        {
+            std::uint32_t magic, size;
+            std::memcpy(&magic, area + pos, sizeof(magic));
+
+            if (magic != circular_log::record_magic ||
+                capacity - pos < circular_log::record_header_size)
+            {
+                pos += circular_log::record_alignment;
+                continue;
+            }
+
+            std::memcpy(&size, area + pos + 16, sizeof(size));
+
+            if (size > capacity - pos - circular_log::record_header_size)
+                return capacity;
+
+            pos += circular_log::frame_size(size);
+        }
+
+        return std::min(pos, capacity);
+    }
+}
+
+
+
+//******************************************************************************
+
+
+
+circular_log::circular_log() noexcept
+    : m_data{nullptr}
+    , m_capacity{0}
+{
+}
+
+
+circular_log::circular_log(const std::string& path, size_type capacity)
+    : circular_log()
+{
+    this->open(path, capacity);
+}
+
+
+circular_log::~circular_log()
+{
+    this->close();
+}
+
+
+void circular_log::open(const std::string& path, size_type capacity)
+{
+    using namespace detail::circular_log;
+
+    capacity &= ~(record_alignment - 1);
+
+    if (capacity < frame_size(0))
+        CIX_THROW_BADARG("circular_log capacity too small ({})", capacity);
+
+    std::scoped_lock lock(m_mutex);
+
+    m_file.reset();
+    m_data = nullptr;
+    m_capacity = 0;
+
+    auto file = std::make_unique<file_mapping>(
+        path, true, std::uint64_t{capacity} + sizeof(header_t));
+    auto* header = header_of(file->data());
+
+    if (!is_header_valid(*header, file->size()))
+    {
+        std::memset(file->data(), 0, static_cast<std::size_t>(file->size()));
+        std::memcpy(header->magic, file_magic, sizeof(file_magic));
+        header->version = file_version;
+        header->header_size = sizeof(header_t);
+        header->capacity = capacity;
+    }
+
+    m_file = std::move(file);
+    m_data = m_file->data() + sizeof(header_t);
+    m_capacity = capacity;
+}
+
+
+void circular_log::close() noexcept
+{
+    std::scoped_lock lock(m_mutex);
+
+    m_file.reset();
+    m_data = nullptr;
+    m_capacity = 0;
+}
+
+
+bool circular_log::is_open() const noexcept
+{
+    return m_data != nullptr;
+}
+
+
+circular_log::size_type circular_log::capacity() const noexcept
+{
+    return m_capacity;
+}
+
+
+circular_log::size_type circular_log::cursor() const noexcept
+{
+    return m_file ?
+        static_cast<size_type>(detail::circular_log::header_of(m_file->data())->cursor) :
+        0;
+}
+
+
+std::uint64_t circular_log::loops() const noexcept
+{
+    return m_file ? detail::circular_log::header_of(m_file->data())->loops : 0;
+}
+
+
+circular_log::seq_type circular_log::next_seq() const noexcept
+{
+    return m_file ? detail::circular_log::header_of(m_file->data())->next_seq : 0;
+}
+
+
+circular_log::seq_type circular_log::write(const void* data, size_type size)
+{
+    if (!data && size)
+        CIX_THROW_BADARG("null circular_log record ({} bytes)", size);
+
+    std::scoped_lock lock(m_mutex);
+
+    if (!m_data)
+        CIX_THROW_LOGIC("circular_log not open ({} bytes record)", size);
+
+    if (size > max_payload_size ||
+        size > m_capacity - record_header_size ||
+        frame_size(size) > m_capacity)
+    {
+        CIX_THROW_LENGTH("circular_log record too big ({} bytes)", size);
+    }
+
+    auto* header = detail::circular_log::header_of(m_file->data());
+    const auto frame = frame_size(size);
+    auto cursor = static_cast<size_type>(header->cursor);
+
+    if (frame > m_capacity - cursor)
+    {
+        std::memset(m_data + cursor, 0, m_capacity - cursor);
+        cursor = 0;
+        ++header->loops;
+    }
+
+    // the new frame may end in the middle of a frame of the previous loop,
+    // whose remaining bytes would look like corruption to a reader
+    const auto end = cursor + frame;
+    const auto old_end = detail::circular_log::end_of_overwritten(
+        m_data, m_capacity, cursor, end);
+
+    if (old_end > end)
+        std::memset(m_data + end, 0, old_end - end);
+
+    const auto seq = header->next_seq;
+    const auto size32 = static_cast<std::uint32_t>(size);
+    auto* const p = m_data + cursor;
+
+    std::memcpy(p + 8, &seq, sizeof(seq));
+    std::memcpy(p + 16, &size32, sizeof(size32));
+    if (size > 0)
+        std::memcpy(p + record_header_size, data, size);
+    std::memset(p + record_header_size + size, 0, frame - record_header_size - size);
+
+    const auto crc = crc32::crc32(p + 8, record_header_size - 8 + size);
+    std::memcpy(p + 4, &crc, sizeof(crc));
+    std::memcpy(p, &record_magic, sizeof(record_magic));
+
+    header->cursor = cursor + frame;
+    header->next_seq = seq + 1;
+
+    return seq;
+}
+
+
+circular_log::seq_type circular_log::write(std::string_view data)
+{
+    return this->write(data.data(), data.size());
+}
+
+
+void circular_log::flush(bool async)
+{
+    std::scoped_lock lock(m_mutex);
+
+    if (m_file)
+        m_file->flush(async);
+}
+
+
+
+//******************************************************************************
+
+
+
+circular_log_reader::circular_log_reader(const std::string& path)
+    : m_capacity{0}
+    , m_loops{0}
+    , m_corrupted{0}
+{
+    using namespace detail::circular_log;
+
+    m_file = std::make_unique<file_mapping>(path, false, 0);
+
+    if (m_file->size() < sizeof(header_t))
+        CIX_THROW_RUNTIME("circular_log: truncated file {}", path);
+
+    const auto* header = header_of(m_file->data());
+
+    if (!is_header_valid(*header, m_file->size()))
+        CIX_THROW_RUNTIME("circular_log: invalid header in {}", path);
+
+    m_capacity = static_cast<size_type>(header->capacity);
+    m_loops = header->loops;
+
+    // Scan from the cursor, where the oldest records are, then wrap around.
+    // Records are sorted by sequence number afterwards in case the process
+    // died before updating the cursor.
+    const auto* const area = m_file->data() + sizeof(header_t);
+    const auto cursor = static_cast<size_type>(header->cursor);
+    bool in_corruption = false;
+
+    for (const auto& [begin, end] : {
+            std::pair{cursor, m_capacity},
+            std::pair{size_type{0}, cursor} })
+    {
+        for (auto pos = begin; pos < end; )
+        {
+            entry ent;
+            const auto frame_size = parse_record(area, m_capacity, pos, ent);
+
+            if (frame_size > 0)
+            {
+                m_entries.push_back(ent);
+                in_corruption = false;
+                pos += frame_size;
+                continue;
+            }
+
+            // zeroes are just padding or unused space, but a corrupted region
+            // spans up to the next valid record since a damaged record may
+            // hold zero words too (e.g. the high half of its seq)
+            std::uint32_t word;
+            std::memcpy(&word, area + pos, sizeof(word));
+            if (word != 0 && !in_corruption)
+            {
+                ++m_corrupted;
+                in_corruption = true;
+            }
+
+            pos += circular_log::record_alignment;
+        }
+    }
+
+    std::sort(
+        m_entries.begin(), m_entries.end(),
+        [](const entry& a, const entry& b) { return a.seq < b.seq; });
+}
+
+
+circular_log_reader::~circular_log_reader()
+{
+}
+
+
+circular_log_reader::size_type circular_log_reader::capacity() const noexcept
+{
+    return m_capacity;
+}
+
+
+std::uint64_t circular_log_reader::loops() const noexcept
+{
+    return m_loops;
+}
+
+
+const std::vector<circular_log_reader::entry>&
+circular_log_reader::entries() const noexcept
+{
+    return m_entries;
+}
+
+
+circular_log_reader::size_type circular_log_reader::corrupted() const noexcept
+{
+    return m_corrupted;
+}
+
+}  // namespace cix
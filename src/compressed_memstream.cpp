@@ -0,0 +1,250 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+
+namespace detail::compressed_memstream
+{
+    struct block_header_t
+    {
+        std::uint32_t raw_size;
+        std::uint32_t packed_size;
+        std::uint32_t crc;
+    };
+
+    static_assert(
+        sizeof(block_header_t) ==
+        cix::compressed_memstream::block_header_size);
+
+    inline crc32::hash_t block_crc(
+        const block_header_t& header, const std::uint8_t* payload)
+    {
+        auto ctx = crc32::create();
+        crc32::update(ctx, &header.raw_size, sizeof(header.raw_size));
+        crc32::update(ctx, &header.packed_size, sizeof(header.packed_size));
+        crc32::update(ctx, payload, header.packed_size);
+        return crc32::finalize(ctx);
+    }
+}
+
+
+compressed_memstream::compressed_memstream(
+        memstream& stream, size_type block_size)
+    : m_stream(stream)
+    , m_block_size{block_size}
+    , m_wlen{0}
+    , m_rpos{0}
+    , m_rlen{0}
+{
+    if (!block_size || block_size > std::numeric_limits<std::uint32_t>::max())
+        CIX_THROW_BADARG("invalid compressed_memstream block size");
+}
+
+
+compressed_memstream::~compressed_memstream()
+{
+    // best effort, a destructor must not throw, see the CAUTION note in the
+    // header
+    try
+    {
+        this->flush();
+    }
+    catch (...)
+    {
+    }
+}
+
+
+memstream& compressed_memstream::stream()
+{
+    return m_stream;
+}
+
+
+compressed_memstream::size_type compressed_memstream::block_size() const
+{
+    return m_block_size;
+}
+
+
+compressed_memstream& compressed_memstream::write(
+    const void* data, size_type size)
+{
+    auto src = reinterpret_cast<const std::uint8_t*>(data);
+
+    while (size > 0)
+    {
+        // compress straight from caller's buffer if possible
+        if (m_wlen == 0 && size >= m_block_size)
+        {
+            this->write_block(src, m_block_size);
+            src += m_block_size;
+            size -= m_block_size;
+            continue;
+        }
+
+        if (m_wbuf.size() < m_block_size)
+            m_wbuf.resize(m_block_size);
+
+        const auto len = std::min(size, m_block_size - m_wlen);
+
+        std::memcpy(&m_wbuf[m_wlen], src, len);
+        m_wlen += len;
+        src += len;
+        size -= len;
+
+        if (m_wlen == m_block_size)
+            this->flush();
+    }
+
+    return *this;
+}
+
+
+compressed_memstream& compressed_memstream::read(void* dest, size_type size)
+{
+    auto dst = reinterpret_cast<std::uint8_t*>(dest);
+
+    while (size > 0)
+    {
+        if (m_rpos >= m_rlen && !this->read_block())
+            CIX_THROW_BADARG("reading beyond eof");
+
+        const auto len = std::min(size, m_rlen - m_rpos);
+
+        std::memcpy(dst, &m_rbuf[m_rpos], len);
+        m_rpos += len;
+        dst += len;
+        size -= len;
+    }
+
+    return *this;
+}
+
+
+compressed_memstream& compressed_memstream::write(const std::uint8_t value)
+{
+    return this->write(&value, sizeof(value));
+}
+
+
+compressed_memstream& compressed_memstream::read(std::uint8_t& value)
+{
+    return this->read(&value, sizeof(value));
+}
+
+
+compressed_memstream& compressed_memstream::flush()
+{
+    if (m_wlen > 0)
+    {
+        this->write_block(m_wbuf.data(), m_wlen);
+        m_wlen = 0;
+    }
+
+    return *this;
+}
+
+
+bool compressed_memstream::eof() const
+{
+    return m_rpos >= m_rlen && m_stream.tellr() >= m_stream.size();
+}
+
+
+void compressed_memstream::write_block(const std::uint8_t* data, size_type size)
+{
+    using namespace detail::compressed_memstream;
+
+    assert(size > 0);
+    assert(size <= m_block_size);
+
+    const auto bound = lz::compress_bound(size);
+    auto* out = m_stream.prepare_write(block_header_size + bound);
+    if (!out)
+        CIX_THROW_LOGIC("compressed_memstream: read-only stream");
+
+    auto* payload = out + block_header_size;
+    block_header_t header;
+
+    auto packed_size = lz::compress(data, size, payload, bound);
+    if (!packed_size || packed_size >= size)
+    {
+        // incompressible
+        std::memcpy(payload, data, size);
+        packed_size = size;
+    }
+
+    header.raw_size = static_cast<std::uint32_t>(size);
+    header.packed_size = static_cast<std::uint32_t>(packed_size);
+    header.crc = block_crc(header, payload);
+
+    std::memcpy(out, &header, sizeof(header));
+    m_stream.finalize_write(block_header_size + packed_size);
+}
+
+
+bool compressed_memstream::read_block()
+{
+    using namespace detail::compressed_memstream;
+
+    const auto avail = m_stream.size() - m_stream.tellr();
+    if (m_stream.tellr() >= m_stream.size() || avail == 0)
+        return false;
+
+    if (avail < block_header_size)
+        CIX_THROW_RUNTIME("compressed_memstream: truncated block header");
+
+    block_header_t header;
+    m_stream.read(&header, sizeof(header));
+
+    if (header.packed_size > avail - block_header_size)
+        CIX_THROW_RUNTIME("compressed_memstream: truncated block");
+
+    // also protects against allocating an insane amount of memory due to a
+    // corrupted header
+    if (!header.raw_size ||
+        header.raw_size > m_block_size ||
+        header.packed_size > lz::compress_bound(header.raw_size))
+    {
+        CIX_THROW_RUNTIME(
+            "compressed_memstream: invalid block size ({} -> {})",
+            header.packed_size, header.raw_size);
+    }
+
+    const auto* payload = m_stream.data() + m_stream.tellr();
+
+    if (block_crc(header, payload) != header.crc)
+        CIX_THROW_RUNTIME("compressed_memstream: block integrity check failed");
+
+    if (m_rbuf.size() < header.raw_size)
+        m_rbuf.resize(header.raw_size);
+
+    if (header.packed_size == header.raw_size)
+    {
+        std::memcpy(m_rbuf.data(), payload, header.raw_size);
+    }
+    else
+    {
+        const auto len = lz::decompress(
+            payload, header.packed_size, m_rbuf.data(), header.raw_size);
+
+        if (len != header.raw_size)
+            CIX_THROW_RUNTIME("compressed_memstream: corrupted block");
+    }
+
+    m_stream.seekr(
+        static_cast<memstream::off_type>(header.packed_size),
+        memstream::seek_cur);
+
+    m_rpos = 0;
+    m_rlen = header.raw_size;
+
+    return true;
+}
+
+}  // namespace cix
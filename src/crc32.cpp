@@ -73,6 +73,35 @@ namespace detail
         0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
         0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
     };
+
+    // Tables for the slicing-by-8 variant: crc32_slices[k][i] is the crc of
+    // byte *i* followed by *k* zero bytes, so that 8 bytes can be processed
+    // per iteration with independent table lookups.
+    struct slice_tables
+    {
+        hash_t tab[8][256];
+    };
+
+    static constexpr slice_tables make_slice_tables() noexcept
+    {
+        slice_tables slices{};
+
+        for (std::size_t i = 0; i < 256; ++i)
+            slices.tab[0][i] = crc32_tab[i];
+
+        for (std::size_t k = 1; k < 8; ++k)
+        {
+            for (std::size_t i = 0; i < 256; ++i)
+            {
+                const auto prev = slices.tab[k - 1][i];
+                slices.tab[k][i] = (prev >> 8) ^ crc32_tab[prev & 0xff];
+            }
+        }
+
+        return slices;
+    }
+
+    static constexpr slice_tables crc32_slices = make_slice_tables();
 }
 
 
@@ -113,6 +142,29 @@ void update(hash_t& ctx, const void* begin, std::size_t size) noexcept
 
     auto p = reinterpret_cast<const std::uint8_t*>(begin);
 
+#if CIX_ENDIAN_LITTLE
+    const auto& tab = detail::crc32_slices.tab;
+
+    for (; size >= 8; size -= 8, p += 8)
+    {
+        std::uint32_t lo, hi;
+        std::memcpy(&lo, p, sizeof(lo));
+        std::memcpy(&hi, p + 4, sizeof(hi));
+
+        lo ^= ctx;
+
+        ctx =
+            tab[7][lo & 0xff] ^
+            tab[6][(lo >> 8) & 0xff] ^
+            tab[5][(lo >> 16) & 0xff] ^
+            tab[4][lo >> 24] ^
+            tab[3][hi & 0xff] ^
+            tab[2][(hi >> 8) & 0xff] ^
+            tab[1][(hi >> 16) & 0xff] ^
+            tab[0][hi >> 24];
+    }
+#endif
+
     for (; size; --size, ++p)
         ctx = detail::crc32_tab[(ctx ^ *p) & 0xff] ^ (ctx >> 8);
 }
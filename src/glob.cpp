@@ -0,0 +1,459 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+namespace string {
+
+namespace detail::glob
+{
+    using cix::detail::lowest_bit;
+
+
+    inline void set_bit(
+        std::vector<word_type>& bits, size_type offset, size_type pos) noexcept
+    {
+        bits[offset + (pos / word_bits)] |= word_type(1) << (pos % word_bits);
+    }
+
+
+    void program::add(const std::vector<std::uint32_t>& pattern, glob_flags flags)
+    {
+        if (m_patterns >= std::numeric_limits<std::uint32_t>::max())
+            CIX_THROW_LENGTH("glob: too many patterns ({})", m_patterns);
+
+        if (!this->add_literal(pattern, flags))
+            this->add_tokens(pattern, flags);
+
+        ++m_patterns;
+    }
+
+
+    // Add *pattern* to the literal or suffix patterns if it is either a plain
+    // literal or a "*" followed by one. Return false otherwise, including if
+    // *pattern* is malformed so that add_tokens() reports it.
+    bool program::add_literal(
+        const std::vector<std::uint32_t>& pattern, glob_flags flags)
+    {
+        const bool path = flags & glob_path;
+        const bool escape = !(flags & glob_no_escape);
+        const auto len = pattern.size();
+        size_type pos = 0;
+
+        // "**" may be a whole component in path mode
+        while (pos < len && pattern[pos] == '*')
+            ++pos;
+
+        if (pos > 1 && path)
+            return false;
+
+        const bool suffix = pos > 0;
+        const auto offset = m_literal_units.size();
+
+        for (; pos < len; ++pos)
+        {
+            auto u = pattern[pos];
+
+            if (u == '*' || u == '?' || u == '[')
+                break;
+
+            if (u == '\\' && escape)
+            {
+                // leave a trailing escape to add_tokens(), which rejects it
+                if (pos + 1 == len)
+                    break;
+
+                u = pattern[++pos];
+            }
+
+            // a separator matches any separator in path mode
+            if (path && is_sep(u))
+                break;
+
+            m_literal_units.push_back(u);
+        }
+
+        const auto length = m_literal_units.size() - offset;
+
+        if (pos < len || (suffix && !length) ||
+            m_literal_units.size() > std::numeric_limits<std::uint32_t>::max())
+        {
+            m_literal_units.resize(offset);
+            return false;
+        }
+
+        const literal_t literal{
+            static_cast<std::uint32_t>(m_patterns),
+            static_cast<std::uint32_t>(offset),
+            static_cast<std::uint32_t>(length),
+            static_cast<bool>(flags & glob_icase),
+            suffix && path };
+
+        const auto key = hash(m_literal_units.data() + offset, length);
+
+        if (!suffix)
+        {
+            m_exact.emplace(key, literal);
+        }
+        else
+        {
+            m_suffixes.emplace(key, literal);
+
+            const auto it = std::lower_bound(
+                m_suffix_lengths.begin(), m_suffix_lengths.end(), length);
+
+            if (it == m_suffix_lengths.end() || *it != length)
+                m_suffix_lengths.insert(it, length);
+        }
+
+        return true;
+    }
+
+
+    void program::add_tokens(
+        const std::vector<std::uint32_t>& pattern, glob_flags flags)
+    {
+        const bool icase = flags & glob_icase;
+        const bool path = flags & glob_path;
+        const bool escape = !(flags & glob_no_escape);
+        const auto pattern_index = static_cast<std::uint32_t>(m_patterns);
+        const auto first_token = m_tokens.size();
+        const auto len = pattern.size();
+
+        const auto push = [&](
+            token_kind kind, bool negate, bool no_sep, bool skip,
+            size_type ranges_begin)
+        {
+            m_tokens.push_back({
+                kind, negate, no_sep, skip,
+                static_cast<std::uint32_t>(ranges_begin),
+                static_cast<std::uint32_t>(m_ranges.size()),
+                pattern_index });
+        };
+
+        const auto add_range = [&](std::uint32_t lo, std::uint32_t hi) {
+            if (lo > hi)
+                return;
+
+            m_ranges.emplace_back(lo, hi);
+
+            if (icase)
+            {
+                // letters of the range, in the other case
+                for (const auto& [first, last] : {
+                    std::pair<std::uint32_t, std::uint32_t>('A', 'Z'),
+                    std::pair<std::uint32_t, std::uint32_t>('a', 'z') })
+                {
+                    const auto a = std::max(lo, first);
+                    const auto b = std::min(hi, last);
+
+                    if (a <= b)
+                        m_ranges.emplace_back(a ^ 0x20u, b ^ 0x20u);
+                }
+            }
+        };
+
+        const auto push_sep = [&]() {
+            const auto ranges_begin = m_ranges.size();
+            m_ranges.emplace_back('/', '/');
+            m_ranges.emplace_back('\\', '\\');
+            push(tk_chars, false, false, false, ranges_begin);
+        };
+
+        const auto is_pattern_sep = [&](size_type pos) {
+            return
+                path && pos < len && is_sep(pattern[pos]) &&
+                !(escape && pattern[pos] == '\\');
+        };
+
+        bool component_start = true;
+
+        for (size_type pos = 0; pos < len; )
+        {
+            const auto u = pattern[pos];
+
+            if (u == '*')
+            {
+                auto end = pos;
+                while (end < len && pattern[end] == '*')
+                    ++end;
+
+                if (path && end - pos > 1 && component_start &&
+                    (end == len || is_pattern_sep(end)))
+                {
+                    const auto count = m_tokens.size() - first_token;
+
+                    if (end == len)
+                    {
+                        push(tk_globstar, false, false, false, m_ranges.size());
+                        pos = end;
+                    }
+                    else
+                    {
+                        // "**/**/" is the same as "**/"
+                        if (count < 2 ||
+                            m_tokens[m_tokens.size() - 2].kind != tk_globstar ||
+                            !m_tokens[m_tokens.size() - 2].skip)
+                        {
+                            push(tk_globstar, false, false, true, m_ranges.size());
+                            push_sep();
+                        }
+
+                        pos = end + 1;
+                    }
+
+                    continue;
+                }
+
+                if (m_tokens.size() == first_token || m_tokens.back().kind != tk_star)
+                    push(tk_star, false, path, false, m_ranges.size());
+
+                component_start = false;
+                pos = end;
+                continue;
+            }
+
+            if (u == '?')
+            {
+                push(tk_chars, true, path, false, m_ranges.size());
+                component_start = false;
+                ++pos;
+                continue;
+            }
+
+            if (u == '[')
+            {
+                const auto ranges_begin = m_ranges.size();
+                auto end = pos + 1;
+                bool negate = false;
+
+                const auto next_unit = [&]() {
+                    if (end < len && pattern[end] == '\\' && escape)
+                        ++end;
+
+                    if (end >= len)
+                    {
+                        CIX_THROW_BADARG(
+                            "glob: unterminated bracket expression at offset {}",
+                            pos);
+                    }
+
+                    return pattern[end++];
+                };
+
+                if (end < len && (pattern[end] == '!' || pattern[end] == '^'))
+                {
+                    negate = true;
+                    ++end;
+                }
+
+                for (bool first = true; ; first = false)
+                {
+                    if (end < len && pattern[end] == ']' && !first)
+                    {
+                        ++end;
+                        break;
+                    }
+
+                    const auto lo = next_unit();
+                    auto hi = lo;
+
+                    if (end + 1 < len && pattern[end] == '-' && pattern[end + 1] != ']')
+                    {
+                        ++end;
+                        hi = next_unit();
+                    }
+
+                    add_range(lo, hi);
+                }
+
+                push(tk_chars, negate, path, false, ranges_begin);
+                component_start = false;
+                pos = end;
+                continue;
+            }
+
+            if (is_pattern_sep(pos))
+            {
+                push_sep();
+                component_start = true;
+                ++pos;
+                continue;
+            }
+
+            auto literal = u;
+
+            if (u == '\\' && escape)
+            {
+                if (pos + 1 == len)
+                    CIX_THROW_BADARG("glob: trailing escape character at offset {}", pos);
+
+                literal = pattern[++pos];
+            }
+
+            const auto ranges_begin = m_ranges.size();
+            add_range(literal, literal);
+            push(tk_chars, false, false, false, ranges_begin);
+            component_start = false;
+            ++pos;
+        }
+
+        push(tk_accept, false, false, false, m_ranges.size());
+    }
+
+
+    void program::compile()
+    {
+        if (m_tokens.empty())
+            return;
+
+        const auto positions = m_tokens.size();
+        const auto words = (positions + word_bits - 1) / word_bits;
+
+        // Classes start at each bound, so that a class is the range of units
+        // between two bounds. Every token either matches all the units of a
+        // class or none of them, which is then told by the first unit of the
+        // class.
+        {
+            std::vector<std::uint64_t> bounds{ 0, '/', '/' + 1, '\\', '\\' + 1 };
+
+            bounds.reserve(bounds.size() + (m_ranges.size() * 2));
+
+            for (const auto& [lo, hi] : m_ranges)
+            {
+                bounds.push_back(lo);
+                bounds.push_back(std::uint64_t(hi) + 1);
+            }
+
+            std::sort(bounds.begin(), bounds.end());
+            bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+            if (bounds.back() > std::numeric_limits<std::uint32_t>::max())
+                bounds.pop_back();
+
+            m_bounds.assign(bounds.begin(), bounds.end());
+        }
+
+        const auto classes = m_bounds.size();
+
+        for (std::uint32_t u = 0; u < m_low_classes.size(); ++u)
+        {
+            m_low_classes[u] = static_cast<std::uint32_t>(
+                std::upper_bound(m_bounds.begin(), m_bounds.end(), u) -
+                m_bounds.begin() - 1);
+        }
+
+        m_words = words;
+        m_consume.assign(classes * words, 0);
+        m_loop.assign(classes * words, 0);
+        m_skip.assign(words, 0);
+        m_star.assign(words, 0);
+        m_init.assign(words, 0);
+        m_accept.assign(words, 0);
+        m_bit_pattern.resize(positions);
+
+        bool pattern_start = true;
+
+        for (size_type pos = 0; pos < positions; ++pos)
+        {
+            const auto& token = m_tokens[pos];
+
+            m_bit_pattern[pos] = token.pattern;
+
+            if (pattern_start)
+                set_bit(m_init, 0, pos);
+
+            pattern_start = token.kind == tk_accept;
+
+            if (token.kind == tk_accept)
+            {
+                set_bit(m_accept, 0, pos);
+                continue;
+            }
+
+            if (token.kind == tk_star || token.kind == tk_globstar)
+                set_bit(m_star, 0, pos);
+
+            if (token.skip)
+                set_bit(m_skip, 0, pos);
+
+            for (size_type cls = 0; cls < classes; ++cls)
+            {
+                const auto u = m_bounds[cls];
+
+                if (token.no_sep && is_sep(u))
+                    continue;
+
+                if (token.kind != tk_chars)
+                {
+                    set_bit(m_loop, cls * words, pos);
+                    continue;
+                }
+
+                const auto first = m_ranges.begin() + token.ranges_begin;
+                const auto last = m_ranges.begin() + token.ranges_end;
+                const bool in_ranges = std::any_of(first, last, [u](const auto& range) {
+                    return u >= range.first && u <= range.second;
+                });
+
+                if (in_ranges != token.negate)
+                    set_bit(m_consume, cls * words, pos);
+            }
+        }
+
+        // positions entered initially, see run()
+        {
+            word_type carry_skip = 0;
+            word_type carry_star = 0;
+
+            for (size_type w = 0; w < words; ++w)
+            {
+                auto n = m_init[w];
+
+                const auto skipped = n & m_skip[w];
+                n |= (skipped << 2) | carry_skip;
+                carry_skip = skipped >> (word_bits - 2);
+
+                const auto starred = n & m_star[w];
+                n |= (starred << 1) | carry_star;
+                carry_star = starred >> (word_bits - 1);
+
+                m_init[w] = n;
+            }
+        }
+
+        m_tokens.clear();
+        m_tokens.shrink_to_fit();
+        m_ranges.clear();
+        m_ranges.shrink_to_fit();
+    }
+
+
+    size_type program::first_accepted(const word_type* state) const noexcept
+    {
+        for (size_type w = 0; w < m_words; ++w)
+        {
+            if (const auto bits = state[w] & m_accept[w])
+                return m_bit_pattern[(w * word_bits) + lowest_bit(bits)];
+        }
+
+        return npos;
+    }
+
+
+    void program::all_accepted(
+        const word_type* state, std::vector<size_type>& out) const
+    {
+        for (size_type w = 0; w < m_words; ++w)
+        {
+            for (auto bits = state[w] & m_accept[w]; bits; bits &= bits - 1)
+                out.push_back(m_bit_pattern[(w * word_bits) + lowest_bit(bits)]);
+        }
+    }
+}  // namespace detail::glob
+
+}  // namespace string
+}  // namespace cix
@@ -0,0 +1,337 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+namespace string {
+
+namespace detail::intern
+{
+    typedef intern_pool::size_type size_type;
+    typedef intern_pool::symbol_type symbol_type;
+
+    // arena blocks start small so that a pool with many shards and few
+    // strings stays small, then grow with the arena up to max_block
+    static constexpr size_type min_block = 4 * 1024;
+    static constexpr size_type max_block = 64 * 1024;
+
+    // strings bigger than this get a block of their own, so that they do not
+    // waste the end of the current block
+    static constexpr size_type max_small = max_block / 4;
+
+    static constexpr size_type min_slots = 16;
+
+
+    // see cix::detail::fx_hash(), both the low bits (slot) and the high bits
+    // (shard) are usable
+    inline std::uint64_t hash(const char* s, size_type len) noexcept
+    {
+        return cix::detail::fx_hash(s, len);
+    }
+
+
+    using cix::detail::highest_bit;
+
+
+    // an entry of the hash index of a shard, the string itself is reached
+    // through the ID-to-view table of the pool
+    struct slot_t
+    {
+        std::uint32_t hash;  // low 32 bits of the hash of the string
+        std::uint32_t id;    // ID + 1, 0 if the slot is free
+    };
+
+
+    struct alignas(cache_line_size) shard_t
+    {
+        mutable std::shared_mutex mutex;
+
+        // open addressing with linear probing, the size is a power of two and
+        // the load factor is kept under 3/4
+        std::vector<slot_t> slots;
+        size_type count = 0;
+
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char* cursor = nullptr;
+        size_type remaining = 0;
+
+        size_type string_bytes = 0;
+        size_type arena_bytes = 0;
+
+        // copy *str* to the arena, null-terminated
+        std::string_view store(std::string_view str)
+        {
+            const auto size = str.size() + 1;
+            char* dest;
+
+            if (size > max_small)
+            {
+                blocks.emplace_back(new char[size]);
+                arena_bytes += size;
+                dest = blocks.back().get();
+            }
+            else
+            {
+                if (size > remaining)
+                {
+                    const auto block_size = std::clamp(
+                        arena_bytes, min_block, max_block);
+
+                    blocks.emplace_back(new char[block_size]);
+                    arena_bytes += block_size;
+                    cursor = blocks.back().get();
+                    remaining = block_size;
+                }
+
+                dest = cursor;
+                cursor += size;
+                remaining -= size;
+            }
+
+            std::memcpy(dest, str.data(), str.size());
+            dest[str.size()] = '\0';
+
+            return std::string_view(dest, str.size());
+        }
+
+        // double the size of the index if inserting one more entry would
+        // exceed the maximal load factor
+        void reserve_one()
+        {
+            if ((count + 1) * 4 <= slots.size() * 3)
+                return;
+
+            std::vector<slot_t> grown(std::max(min_slots, slots.size() * 2));
+            const auto mask = grown.size() - 1;
+
+            for (const auto& slot : slots)
+            {
+                if (!slot.id)
+                    continue;
+
+                auto idx = slot.hash & mask;
+                while (grown[idx].id)
+                    idx = (idx + 1) & mask;
+
+                grown[idx] = slot;
+            }
+
+            slots.swap(grown);
+        }
+    };
+}  // namespace detail::intern
+
+
+intern_pool::intern_pool(size_type shards)
+    : m_shards{}
+    , m_shard_mask{0}
+    , m_next_id{0}
+    , m_segments{}
+{
+    if (shards == 0)
+        shards = 2 * std::max(1u, std::thread::hardware_concurrency());
+
+    shards = std::min(shards, max_shards);
+
+    size_type pow2 = 1;
+    while (pow2 < shards)
+        pow2 <<= 1;
+
+    m_shards.reset(new detail::intern::shard_t[pow2]);
+    m_shard_mask = pow2 - 1;
+}
+
+
+intern_pool::~intern_pool()
+{
+    for (auto& segment : m_segments)
+        delete[] segment.load(std::memory_order_relaxed);
+}
+
+
+intern_pool::size_type intern_pool::size() const noexcept
+{
+    return static_cast<size_type>(std::min<std::uint64_t>(
+        m_next_id.load(std::memory_order_acquire), max_symbols));
+}
+
+
+intern_pool::symbol intern_pool::intern(std::string_view str)
+{
+    const auto hash = detail::intern::hash(str.data(), str.size());
+    const auto hash32 = static_cast<std::uint32_t>(hash);
+    auto& shard = m_shards[(hash >> 56) & m_shard_mask];
+
+    // fast path: most strings interned by a long-running program are already
+    // there, which only requires a shared lock
+    {
+        std::shared_lock lock(shard.mutex);
+        const auto id = this->find_in(shard, str, hash32);
+
+        if (id != npos)
+            return { id, this->view(id) };
+    }
+
+    std::unique_lock lock(shard.mutex);
+
+    // another thread may have interned the same string in the meantime
+    if (const auto id = this->find_in(shard, str, hash32); id != npos)
+        return { id, this->view(id) };
+
+    shard.reserve_one();
+
+    const auto stored = shard.store(str);
+    const auto id = this->allocate_id(stored);
+
+    const auto mask = shard.slots.size() - 1;
+    auto idx = hash32 & mask;
+    while (shard.slots[idx].id)
+        idx = (idx + 1) & mask;
+
+    shard.slots[idx] = { hash32, id + 1 };
+    shard.count += 1;
+    shard.string_bytes += str.size();
+
+    return { id, stored };
+}
+
+
+intern_pool::symbol_type intern_pool::find(std::string_view str) const
+{
+    const auto hash = detail::intern::hash(str.data(), str.size());
+    const auto hash32 = static_cast<std::uint32_t>(hash);
+    const auto& shard = m_shards[(hash >> 56) & m_shard_mask];
+
+    std::shared_lock lock(shard.mutex);
+    return this->find_in(shard, str, hash32);
+}
+
+
+std::string_view intern_pool::view(symbol_type id) const noexcept
+{
+    CIX_ASSERT(id < this->size());
+
+    const auto segment = segment_of(id);
+    const auto* table = m_segments[segment].load(std::memory_order_acquire);
+
+    // null only if *id* is not a valid symbol yet
+    if (!table)
+        return std::string_view();
+
+    return table[id - segment_base(segment)];
+}
+
+
+intern_pool::stats_type intern_pool::stats() const
+{
+    stats_type stats{};
+
+    stats.shards = this->shards();
+    stats.min_shard_symbols = std::numeric_limits<size_type>::max();
+
+    for (size_type idx = 0; idx <= m_shard_mask; ++idx)
+    {
+        const auto& shard = m_shards[idx];
+        std::shared_lock lock(shard.mutex);
+
+        stats.symbols += shard.count;
+        stats.string_bytes += shard.string_bytes;
+        stats.arena_bytes += shard.arena_bytes;
+        stats.index_bytes += shard.slots.capacity() * sizeof(shard.slots[0]);
+        stats.max_shard_symbols = std::max(stats.max_shard_symbols, shard.count);
+        stats.min_shard_symbols = std::min(stats.min_shard_symbols, shard.count);
+    }
+
+    for (unsigned segment = 0; segment < segment_count; ++segment)
+    {
+        if (m_segments[segment].load(std::memory_order_acquire))
+            stats.index_bytes += segment_size(segment) * sizeof(std::string_view);
+    }
+
+    return stats;
+}
+
+
+unsigned intern_pool::segment_of(symbol_type id) noexcept
+{
+    const auto high = id >> first_segment_bits;
+    return high ? 1 + detail::intern::highest_bit(high) : 0;
+}
+
+
+intern_pool::size_type intern_pool::segment_base(unsigned segment) noexcept
+{
+    return segment ? size_type(1) << (segment + first_segment_bits - 1) : 0;
+}
+
+
+intern_pool::size_type intern_pool::segment_size(unsigned segment) noexcept
+{
+    return size_type(1) << (segment ? segment + first_segment_bits - 1 : first_segment_bits);
+}
+
+
+intern_pool::symbol_type intern_pool::find_in(
+    const detail::intern::shard_t& shard,
+    std::string_view str, std::uint32_t hash32) const noexcept
+{
+    if (shard.slots.empty())
+        return npos;
+
+    const auto mask = shard.slots.size() - 1;
+
+    for (auto idx = hash32 & mask; ; idx = (idx + 1) & mask)
+    {
+        const auto& slot = shard.slots[idx];
+
+        if (!slot.id)
+            return npos;
+
+        if (slot.hash == hash32 && this->view(slot.id - 1) == str)
+            return slot.id - 1;
+    }
+}
+
+
+std::string_view* intern_pool::segment_for_write(unsigned segment)
+{
+    auto* table = m_segments[segment].load(std::memory_order_acquire);
+    if (table)
+        return table;
+
+    // shards allocate IDs concurrently, the first one to need a segment
+    // publishes it
+    std::unique_ptr<std::string_view[]> fresh(
+        new std::string_view[segment_size(segment)]);
+
+    if (m_segments[segment].compare_exchange_strong(
+        table, fresh.get(),
+        std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        return fresh.release();
+    }
+
+    return table;
+}
+
+
+intern_pool::symbol_type intern_pool::allocate_id(std::string_view str)
+{
+    const auto next = m_next_id.fetch_add(1, std::memory_order_acq_rel);
+
+    if (next >= max_symbols)
+        CIX_THROW_LENGTH("intern_pool: too many symbols ({})", max_symbols);
+
+    const auto id = static_cast<symbol_type>(next);
+    const auto segment = segment_of(id);
+
+    this->segment_for_write(segment)[id - segment_base(segment)] = str;
+
+    return id;
+}
+
+}  // namespace string
+}  // namespace cix
@@ -0,0 +1,408 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+// The block format and the parsing rules implemented here are those of LZ4:
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+//
+// Restrictions honored by compress() so that any LZ4 decoder can read its
+// output:
+// * the last 5 bytes of input are always literals
+// * the last match starts at least 12 bytes before the end of input
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+namespace lz {
+
+namespace detail
+{
+    static constexpr std::size_t min_match = 4;
+    static constexpr std::size_t last_literals = 5;
+    static constexpr std::size_t mf_limit = 12;
+    static constexpr std::size_t max_distance = 65535;
+    static constexpr std::size_t run_mask = 15;
+    static constexpr std::size_t ml_mask = 15;
+
+    // 4096 entries * 4 bytes = 16 KiB on the stack: fits in L1
+    static constexpr unsigned hash_log = 12;
+    static constexpr std::size_t hash_size = std::size_t(1) << hash_log;
+
+    // skip faster over incompressible data
+    static constexpr unsigned skip_trigger = 6;
+
+    inline std::uint32_t read32(const std::uint8_t* p) noexcept
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline std::uint64_t read64(const std::uint8_t* p) noexcept
+    {
+        std::uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline void write16le(std::uint8_t* p, std::uint16_t v) noexcept
+    {
+        p[0] = static_cast<std::uint8_t>(v & 0xff);
+        p[1] = static_cast<std::uint8_t>(v >> 8);
+    }
+
+    inline std::uint32_t hash(std::uint32_t sequence) noexcept
+    {
+        // Knuth's multiplicative hash
+        return (sequence * 2654435761u) >> (32 - hash_log);
+    }
+
+    // number of leading bytes that are equal in two 64-bit words which are
+    // known to differ
+    inline unsigned equal_bytes(std::uint64_t diff) noexcept
+    {
+    #if CIX_ENDIAN_LITTLE
+        return cix::detail::lowest_bit(diff) >> 3;
+    #else
+        return (63u - cix::detail::highest_bit(diff)) >> 3;
+    #endif
+    }
+
+    // length of the common prefix of *ip* and *ref*, without reading past
+    // *limit*
+    inline std::size_t count(
+        const std::uint8_t* ip,
+        const std::uint8_t* ref,
+        const std::uint8_t* limit) noexcept
+    {
+        const auto* const start = ip;
+
+        while (ip + sizeof(std::uint64_t) <= limit)
+        {
+            const auto diff = read64(ref) ^ read64(ip);
+            if (diff)
+                return static_cast<std::size_t>(ip - start) + equal_bytes(diff);
+
+            ip += sizeof(std::uint64_t);
+            ref += sizeof(std::uint64_t);
+        }
+
+        while (ip < limit && *ip == *ref)
+        {
+            ++ip;
+            ++ref;
+        }
+
+        return static_cast<std::size_t>(ip - start);
+    }
+
+    inline std::uint8_t* write_length(std::uint8_t* op, std::size_t len) noexcept
+    {
+        for (; len >= 255; len -= 255)
+            *op++ = 255;
+        *op++ = static_cast<std::uint8_t>(len);
+        return op;
+    }
+
+    // decode an extended length field; returns false on truncated input
+    inline bool read_length(
+        const std::uint8_t*& ip,
+        const std::uint8_t* iend,
+        std::size_t& len) noexcept
+    {
+        std::uint8_t s;
+
+        do
+        {
+            if (ip >= iend)
+                return false;
+
+            s = *ip++;
+            len += s;
+
+            // paranoid overflow check on 32-bit platforms
+            if (len < s)
+                return false;
+        }
+        while (s == 255);
+
+        return true;
+    }
+}
+
+
+std::size_t compress(
+    const void* src_, std::size_t src_size,
+    void* dest_, std::size_t dest_capacity) noexcept
+{
+    using namespace detail;
+
+    if ((!src_ && src_size) || !dest_)
+    {
+        assert(0);
+        return 0;
+    }
+
+    if (dest_capacity < compress_bound(src_size))
+        return 0;
+
+    const auto* const base = static_cast<const std::uint8_t*>(src_);
+    const auto* const iend = base + src_size;
+    const auto* ip = base;
+    const auto* anchor = base;
+    auto* const dest = static_cast<std::uint8_t*>(dest_);
+    auto* op = dest;
+
+    // positions are stored relative to *base* so that 16 KiB are enough
+    // whatever the input size; input is expected to be cut in blocks anyway
+    static_assert(sizeof(std::uint32_t) * hash_size == 16 * 1024);
+    std::uint32_t table[hash_size] = {};
+
+    if (src_size > mf_limit && src_size <= std::numeric_limits<std::uint32_t>::max())
+    {
+        const auto* const mflimit = iend - mf_limit;
+        const auto* const matchlimit = iend - last_literals;
+
+        table[hash(read32(ip))] = 0;
+        ++ip;
+
+        for (;;)
+        {
+            const std::uint8_t* ref;
+            std::uint8_t* token;
+
+            // find a match
+            {
+                unsigned search = 1u << skip_trigger;
+
+                for (;;)
+                {
+                    if (ip > mflimit)
+                        goto __last_literals;
+
+                    const auto seq = read32(ip);
+                    const auto h = hash(seq);
+
+                    ref = base + table[h];
+                    table[h] = static_cast<std::uint32_t>(ip - base);
+
+                    if (static_cast<std::size_t>(ip - ref) <= max_distance &&
+                        read32(ref) == seq)
+                    {
+                        break;
+                    }
+
+                    ip += search++ >> skip_trigger;
+                }
+            }
+
+            // extend match backward
+            while (ip > anchor && ref > base && ip[-1] == ref[-1])
+            {
+                --ip;
+                --ref;
+            }
+
+            // literal run
+            {
+                const auto lit_len = static_cast<std::size_t>(ip - anchor);
+
+                token = op++;
+
+                if (lit_len >= run_mask)
+                {
+                    *token = static_cast<std::uint8_t>(run_mask << 4);
+                    op = write_length(op, lit_len - run_mask);
+                }
+                else
+                {
+                    *token = static_cast<std::uint8_t>(lit_len << 4);
+                }
+
+                std::memcpy(op, anchor, lit_len);
+                op += lit_len;
+            }
+
+        __next_match:
+            // offset
+            write16le(op, static_cast<std::uint16_t>(ip - ref));
+            op += 2;
+
+            // match length
+            {
+                const auto match_len =
+                    count(ip + min_match, ref + min_match, matchlimit);
+
+                ip += min_match + match_len;
+
+                if (match_len >= ml_mask)
+                {
+                    *token += static_cast<std::uint8_t>(ml_mask);
+                    op = write_length(op, match_len - ml_mask);
+                }
+                else
+                {
+                    *token += static_cast<std::uint8_t>(match_len);
+                }
+            }
+
+            anchor = ip;
+
+            if (ip > mflimit)
+                break;
+
+            // fill table
+            table[hash(read32(ip - 2))] = static_cast<std::uint32_t>(ip - 2 - base);
+
+            // immediate match at current position?
+            {
+                const auto seq = read32(ip);
+                const auto h = hash(seq);
+
+                ref = base + table[h];
+                table[h] = static_cast<std::uint32_t>(ip - base);
+
+                if (static_cast<std::size_t>(ip - ref) <= max_distance &&
+                    read32(ref) == seq)
+                {
+                    token = op++;
+                    *token = 0;
+                    goto __next_match;
+                }
+            }
+
+            ++ip;
+        }
+    }
+
+__last_literals:
+    {
+        const auto lit_len = static_cast<std::size_t>(iend - anchor);
+
+        if (lit_len >= run_mask)
+        {
+            *op++ = static_cast<std::uint8_t>(run_mask << 4);
+            op = write_length(op, lit_len - run_mask);
+        }
+        else
+        {
+            *op++ = static_cast<std::uint8_t>(lit_len << 4);
+        }
+
+        if (lit_len > 0)
+            std::memcpy(op, anchor, lit_len);
+        op += lit_len;
+    }
+
+    assert(static_cast<std::size_t>(op - dest) <= compress_bound(src_size));
+
+    return static_cast<std::size_t>(op - dest);
+}
+
+
+std::size_t decompress(
+    const void* src_, std::size_t src_size,
+    void* dest_, std::size_t dest_capacity) noexcept
+{
+    using namespace detail;
+
+    // compress() emits at least one token, so an empty block is malformed
+    // input, not a programming error
+    if (!src_size)
+        return npos;
+
+    if (!src_ || (!dest_ && dest_capacity))
+    {
+        assert(0);
+        return npos;
+    }
+
+    const auto* ip = static_cast<const std::uint8_t*>(src_);
+    const auto* const iend = ip + src_size;
+    auto* const dest = static_cast<std::uint8_t*>(dest_);
+    auto* op = dest;
+    auto* const oend = dest + dest_capacity;
+
+    for (;;)
+    {
+        if (ip >= iend)
+            return npos;
+
+        const std::size_t token = *ip++;
+
+        // literal run
+        std::size_t lit_len = token >> 4;
+        if (lit_len == run_mask && !read_length(ip, iend, lit_len))
+            return npos;
+
+        if (lit_len > static_cast<std::size_t>(iend - ip) ||
+            lit_len > static_cast<std::size_t>(oend - op))
+        {
+            return npos;
+        }
+
+        if (lit_len > 0)
+            std::memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+
+        // the last sequence is made of literals only
+        if (ip == iend)
+            break;
+
+        // offset
+        if (iend - ip < 2)
+            return npos;
+
+        const std::size_t offset =
+            static_cast<std::size_t>(ip[0]) |
+            (static_cast<std::size_t>(ip[1]) << 8);
+        ip += 2;
+
+        if (offset == 0 || offset > static_cast<std::size_t>(op - dest))
+            return npos;
+
+        // match length
+        std::size_t match_len = token & ml_mask;
+        if (match_len == ml_mask && !read_length(ip, iend, match_len))
+            return npos;
+        match_len += min_match;
+
+        if (match_len > static_cast<std::size_t>(oend - op))
+            return npos;
+
+        // copy match
+        const auto* ref = op - offset;
+        auto* const mend = op + match_len;
+
+        if (offset >= sizeof(std::uint64_t) &&
+            static_cast<std::size_t>(oend - mend) >= sizeof(std::uint64_t))
+        {
+            // wild copy: may write up to 7 bytes past *mend*, which is known
+            // to be in bounds, and each 8-byte chunk is fully available
+            // upstream since offset >= 8
+            do
+            {
+                std::memcpy(op, ref, sizeof(std::uint64_t));
+                op += sizeof(std::uint64_t);
+                ref += sizeof(std::uint64_t);
+            }
+            while (op < mend);
+        }
+        else
+        {
+            // overlapping copy (i.e. run-length encoding) or near end of
+            // output
+            while (op < mend)
+                *op++ = *ref++;
+        }
+
+        op = mend;
+    }
+
+    return static_cast<std::size_t>(op - dest);
+}
+
+}  // namespace lz
+}  // namespace cix
@@ -22,6 +22,73 @@ memstream::memstream(const_pointer data, size_type size)
 }
 
 
+memstream::memstream(const memstream& other)
+    : memstream(other.m_grow_size)
+{
+    *this = other;
+}
+
+
+memstream::memstream(memstream&& other) noexcept
+    : memstream(other.m_grow_size)
+{
+    *this = std::move(other);
+}
+
+
+memstream& memstream::operator=(const memstream& other)
+{
+    if (this == &other)
+        return *this;
+
+    this->clear(true);
+    m_grow_size = other.m_grow_size;
+
+    if (other.read_only())
+    {
+        m_buffer = other.m_buffer;
+        m_size = other.m_size;
+        m_view_size = other.m_view_size;
+        m_rpos = other.m_rpos;
+    }
+    else if (other.m_size > 0)
+    {
+        // deep copy so that both streams can be written independently
+        m_container = std::make_shared<container>(
+            other.m_buffer, other.m_buffer + other.m_size);
+        m_buffer = m_container->data();
+        m_size = other.m_size;
+        m_rpos = other.m_rpos;
+        m_wpos = other.m_wpos;
+    }
+
+    return *this;
+}
+
+
+memstream& memstream::operator=(memstream&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    m_buffer = other.m_buffer;
+    m_grow_size = other.m_grow_size;
+    m_size = other.m_size;
+    m_rpos = other.m_rpos;
+    m_wpos = other.m_wpos;
+    m_view_size = other.m_view_size;
+    m_container = std::move(other.m_container);
+
+    other.m_buffer = nullptr;
+    other.m_size = 0;
+    other.m_rpos = 0;
+    other.m_wpos = 0;
+    other.m_view_size = 0;
+
+    return *this;
+}
+
+
 memstream& memstream::open_read(const_pointer data, size_type size)
 {
     assert(size > 0);
@@ -53,11 +120,9 @@ memstream& memstream::clear(bool free_memory)
     m_wpos = 0;
     m_view_size = 0;
 
-    if (free_memory)
-    {
-        container tmp;
-        m_container.swap(tmp);
-    }
+    // do not reuse a buffer shared with slices, they must remain untouched
+    if (free_memory || m_container.use_count() > 1)
+        m_container.reset();
 
     return *this;
 }
@@ -198,6 +263,54 @@ bool memstream::peek_cmp(
 }
 
 
+memstream_slice memstream::slice(pos_type pos, size_type size) const
+{
+    if (pos > m_size)
+        CIX_THROW_BADARG("slicing out of boundaries");
+
+    if (size == npos)
+        size = m_size - pos;
+    else if (size > m_size - pos)
+        CIX_THROW_BADARG("slicing out of boundaries");
+
+    if (!size)
+        return {};
+
+    if (this->read_only())
+    {
+        // memory not owned, cannot be kept alive
+        auto copy = std::make_shared<container>(
+            &m_buffer[pos], &m_buffer[pos] + size);
+
+        return memstream_slice(
+            std::shared_ptr<const value_type>(copy, copy->data()),
+            size);
+    }
+
+    assert(m_container);
+    assert(m_buffer == m_container->data());
+
+    return memstream_slice(
+        std::shared_ptr<const value_type>(m_container, &m_buffer[pos]),
+        size);
+}
+
+
+memstream_slice memstream::read_slice(size_type size)
+{
+    if (!size)
+        return {};
+
+    if (!this->ensure(size))
+        CIX_THROW_BADARG("reading beyond eof");
+
+    auto out = this->slice(m_rpos, size);
+    m_rpos += size;
+
+    return out;
+}
+
+
 memstream& memstream::write(const std::uint8_t value)
 {
     return this->write(&value, sizeof(value));
@@ -229,7 +342,7 @@ memstream& memstream::finalize_write(size_type written)
     assert(!this->read_only());
     if (!this->read_only())
     {
-        if ((m_container.size() - m_wpos) < written)
+        if (!m_container || (m_container->size() - m_wpos) < written)
             CIX_THROW_BADARG("wrote out of boundaries");
 
         m_wpos += written;
@@ -241,23 +354,54 @@ memstream& memstream::finalize_write(size_type written)
 }
 
 
+void memstream::detach(size_type new_size)
+{
+    assert(m_container);
+    assert(new_size >= m_size);
+
+    auto tmp = std::make_shared<container>();
+
+    tmp->reserve(new_size);
+    tmp->assign(m_buffer, m_buffer + m_size);
+    tmp->resize(new_size);
+
+    m_container.swap(tmp);
+    m_buffer = m_container->data();
+}
+
+
 void memstream::grow(size_type required_extra_size)
 {
     assert(!this->read_only());
 
     if (!this->read_only())
     {
-        assert(m_size <= m_container.size());
-        assert(m_rpos <= m_container.size());
-        assert(m_wpos <= m_container.size());
-
-        if ((m_container.size() - m_wpos) < required_extra_size)
+        if (!m_container)
+            m_container = std::make_shared<container>();
+
+        assert(m_size <= m_container->size());
+        assert(m_rpos <= m_container->size());
+        assert(m_wpos <= m_container->size());
+
+        const auto avail = m_container->size() - m_wpos;
+        const auto new_size = (avail >= required_extra_size) ?
+            m_container->size() :
+            m_wpos + std::max<size_type>(required_extra_size, m_grow_size);
+
+        // Buffer is shared with slices: copy it if bytes they can see are
+        // about to be overwritten, or if it has to be reallocated anyway.
+        // Appending in place does not alter any shared byte.
+        if (m_container.use_count() > 1 &&
+            (m_wpos < m_size || new_size > m_container->capacity()))
+        {
+            this->detach(new_size);
+        }
+        else if (new_size != m_container->size())
         {
-            m_container.resize(
-                m_wpos + std::max<size_type>(required_extra_size, m_grow_size));
-            m_buffer = &m_container[0];
+            m_container->resize(new_size);
         }
 
+        m_buffer = m_container->data();
         assert(m_buffer);
     }
 }
@@ -275,9 +419,10 @@ bool memstream::ensure(size_type read_size)
     }
     else
     {
-        assert(m_size <= m_container.size());
-        assert(m_rpos <= m_container.size());
-        assert(m_wpos <= m_container.size());
+        assert(m_container);
+        assert(m_size <= m_container->size());
+        assert(m_rpos <= m_container->size());
+        assert(m_wpos <= m_container->size());
     }
 #endif
 
@@ -346,4 +491,89 @@ __badarg:
     CIX_THROW_BADARG("offset out of boundaries");
 }
 
+
+
+
+//******************************************************************************
+
+
+
+memstream_slice::memstream_slice() noexcept
+    : m_size{0}
+{
+}
+
+
+memstream_slice::memstream_slice(
+        std::shared_ptr<const value_type> data,
+        size_type size) noexcept
+    : m_data{std::move(data)}
+    , m_size{size}
+{
+    assert(m_data || !m_size);
+}
+
+
+bool memstream_slice::empty() const noexcept
+{
+    return m_size == 0;
+}
+
+
+memstream_slice::size_type memstream_slice::size() const noexcept
+{
+    return m_size;
+}
+
+
+memstream_slice::const_pointer memstream_slice::data() const noexcept
+{
+    return m_data.get();
+}
+
+
+memstream_slice::const_pointer memstream_slice::begin() const noexcept
+{
+    return m_data.get();
+}
+
+
+memstream_slice::const_pointer memstream_slice::end() const noexcept
+{
+    return m_data.get() + m_size;
+}
+
+
+memstream_slice::const_reference memstream_slice::operator[](pos_type pos) const
+{
+    assert(pos < m_size);
+    return m_data.get()[pos];
+}
+
+
+memstream_slice memstream_slice::slice(pos_type pos, size_type size) const
+{
+    if (pos > m_size)
+        CIX_THROW_BADARG("slicing out of boundaries");
+
+    if (size == npos)
+        size = m_size - pos;
+    else if (size > m_size - pos)
+        CIX_THROW_BADARG("slicing out of boundaries");
+
+    if (!size)
+        return {};
+
+    return memstream_slice(
+        std::shared_ptr<const value_type>(m_data, m_data.get() + pos),
+        size);
+}
+
+
+void memstream_slice::reset() noexcept
+{
+    m_data.reset();
+    m_size = 0;
+}
+
 }  // namespace cix
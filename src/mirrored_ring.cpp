@@ -0,0 +1,337 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+
+namespace detail::mirrored_ring
+{
+    typedef cix::mirrored_ring::size_type size_type;
+
+#if CIX_PLATFORM_WINDOWS
+
+    // another thread may grab the reserved address range between
+    // VirtualFree() and MapViewOfFileEx(), in which case we just try again
+    static constexpr unsigned max_map_attempts = 16;
+
+    inline std::uint8_t* map(size_type capacity)
+    {
+        const auto size64 = static_cast<std::uint64_t>(capacity);
+
+        HANDLE mapping = CreateFileMappingW(
+            INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+            static_cast<DWORD>(size64 >> 32),
+            static_cast<DWORD>(size64 & 0xffffffff),
+            nullptr);
+        if (!mapping)
+            CIX_THROW_WINERR(
+                "mirrored_ring: failed to create file mapping ({} bytes)", capacity);
+
+        std::uint8_t* base = nullptr;
+        DWORD error = ERROR_SUCCESS;
+
+        for (unsigned attempt = 0; !base && attempt < max_map_attempts; ++attempt)
+        {
+            auto* addr = reinterpret_cast<std::uint8_t*>(VirtualAlloc(
+                nullptr, capacity * 2, MEM_RESERVE, PAGE_NOACCESS));
+            if (!addr)
+            {
+                error = GetLastError();
+                break;
+            }
+
+            VirtualFree(addr, 0, MEM_RELEASE);
+
+            auto* first = MapViewOfFileEx(
+                mapping, FILE_MAP_ALL_ACCESS, 0, 0, capacity, addr);
+            if (!first)
+            {
+                error = GetLastError();
+                continue;
+            }
+
+            auto* second = MapViewOfFileEx(
+                mapping, FILE_MAP_ALL_ACCESS, 0, 0, capacity, addr + capacity);
+            if (!second)
+            {
+                error = GetLastError();
+                UnmapViewOfFile(first);
+                continue;
+            }
+
+            base = addr;
+        }
+
+        // views hold a reference to the section
+        CloseHandle(mapping);
+
+        if (!base)
+            CIX_THROW_WINERR_N(
+                error, "mirrored_ring: failed to map views ({} bytes)", capacity);
+
+        return base;
+    }
+
+
+    inline void unmap(std::uint8_t* base, size_type capacity) noexcept
+    {
+        UnmapViewOfFile(base + capacity);
+        UnmapViewOfFile(base);
+    }
+
+#else
+
+    inline int create_fd(size_type capacity)
+    {
+        #if CIX_PLATFORM_LINUX
+            const int fd = memfd_create("cix_mirrored_ring", MFD_CLOEXEC);
+            if (fd < 0)
+                CIX_THROW_CRTERR(
+                    "mirrored_ring: memfd_create failed ({} bytes)", capacity);
+            return fd;
+        #else
+            static std::atomic<unsigned> counter{0};
+
+            for (;;)
+            {
+                const auto name = fmt::format(
+                    "/cix_mirrored_ring_{}_{}",
+                    getpid(), counter.fetch_add(1, std::memory_order_relaxed));
+
+                const int fd = shm_open(
+                    name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+                if (fd >= 0)
+                {
+                    shm_unlink(name.c_str());
+                    return fd;
+                }
+
+                if (errno != EEXIST)
+                    CIX_THROW_CRTERR(
+                        "mirrored_ring: shm_open failed ({} bytes)", capacity);
+            }
+        #endif
+    }
+
+
+    inline std::uint8_t* map(size_type capacity)
+    {
+        const int fd = create_fd(capacity);
+        int error = 0;
+        void* addr = MAP_FAILED;
+
+        if (0 != ftruncate(fd, static_cast<off_t>(capacity)))
+        {
+            error = errno;
+        }
+        else
+        {
+            // reserve address space for both views
+            addr = mmap(
+                nullptr, capacity * 2, PROT_NONE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (addr == MAP_FAILED)
+            {
+                error = errno;
+            }
+            else
+            {
+                auto* const base = reinterpret_cast<std::uint8_t*>(addr);
+
+                for (auto* view : { base, base + capacity })
+                {
+                    if (MAP_FAILED == mmap(
+                        view, capacity, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_FIXED, fd, 0))
+                    {
+                        error = errno;
+                        munmap(addr, capacity * 2);
+                        addr = MAP_FAILED;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // mappings hold a reference to the file
+        close(fd);
+
+        if (addr == MAP_FAILED)
+            CIX_THROW_CRTERR_N(
+                error, "mirrored_ring: failed to map views ({} bytes)", capacity);
+
+        return reinterpret_cast<std::uint8_t*>(addr);
+    }
+
+
+    inline void unmap(std::uint8_t* base, size_type capacity) noexcept
+    {
+        munmap(base, capacity * 2);
+    }
+
+#endif
+}
+
+
+
+//******************************************************************************
+
+
+
+mirrored_ring::mirrored_ring() noexcept
+    : m_base{nullptr}
+    , m_capacity{0}
+    , m_head{0}
+    , m_size{0}
+{
+}
+
+
+mirrored_ring::mirrored_ring(size_type min_capacity)
+    : mirrored_ring()
+{
+    this->reset(min_capacity);
+}
+
+
+mirrored_ring::mirrored_ring(mirrored_ring&& other) noexcept
+    : m_base{std::exchange(other.m_base, nullptr)}
+    , m_capacity{std::exchange(other.m_capacity, 0)}
+    , m_head{std::exchange(other.m_head, 0)}
+    , m_size{std::exchange(other.m_size, 0)}
+{
+}
+
+
+mirrored_ring& mirrored_ring::operator=(mirrored_ring&& other) noexcept
+{
+    if (this != &other)
+    {
+        this->release();
+        m_base = std::exchange(other.m_base, nullptr);
+        m_capacity = std::exchange(other.m_capacity, 0);
+        m_head = std::exchange(other.m_head, 0);
+        m_size = std::exchange(other.m_size, 0);
+    }
+
+    return *this;
+}
+
+
+mirrored_ring::~mirrored_ring()
+{
+    this->release();
+}
+
+
+mirrored_ring::size_type mirrored_ring::granularity()
+{
+    static const size_type value = []() -> size_type {
+        #if CIX_PLATFORM_WINDOWS
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return info.dwAllocationGranularity;
+        #else
+            const auto page_size = sysconf(_SC_PAGESIZE);
+            return (page_size > 0) ? static_cast<size_type>(page_size) : 4096;
+        #endif
+    }();
+
+    return value;
+}
+
+
+void mirrored_ring::reset(size_type min_capacity)
+{
+    const auto gran = granularity();
+
+    if (min_capacity > (std::numeric_limits<size_type>::max() / 2) - gran)
+        CIX_THROW_LENGTH("mirrored_ring capacity too big ({})", min_capacity);
+
+    const auto capacity = std::max<size_type>(
+        gran, (min_capacity + gran - 1) / gran * gran);
+
+    this->release();
+
+    m_base = detail::mirrored_ring::map(capacity);
+    m_capacity = capacity;
+}
+
+
+void mirrored_ring::release() noexcept
+{
+    if (m_base)
+        detail::mirrored_ring::unmap(m_base, m_capacity);
+
+    m_base = nullptr;
+    m_capacity = 0;
+    m_head = 0;
+    m_size = 0;
+}
+
+
+void mirrored_ring::clear() noexcept
+{
+    m_head = 0;
+    m_size = 0;
+}
+
+
+void mirrored_ring::consume(size_type count) noexcept
+{
+    assert(count <= m_size);
+    count = std::min(count, m_size);
+
+    m_size -= count;
+    m_head += count;
+
+    if (m_head >= m_capacity)
+        m_head -= m_capacity;
+
+    // keep the cursor at the beginning of the first view as often as possible
+    if (!m_size)
+        m_head = 0;
+}
+
+
+mirrored_ring::size_type mirrored_ring::read(void* dest, size_type size) noexcept
+{
+    assert(dest || !size);
+
+    size = std::min(size, m_size);
+    if (size)
+    {
+        std::memcpy(dest, this->read_ptr(), size);
+        this->consume(size);
+    }
+
+    return size;
+}
+
+
+void mirrored_ring::commit(size_type count) noexcept
+{
+    assert(count <= this->writable());
+    m_size += std::min(count, this->writable());
+}
+
+
+mirrored_ring::size_type mirrored_ring::write(const void* src, size_type size) noexcept
+{
+    assert(src || !size);
+
+    size = std::min(size, this->writable());
+    if (size)
+    {
+        std::memcpy(this->write_ptr(), src, size);
+        this->commit(size);
+    }
+
+    return size;
+}
+
+}  // namespace cix
@@ -0,0 +1,247 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+namespace string {
+
+multi_replacer::multi_replacer(std::initializer_list<pair_type> patterns)
+{
+    for (const auto& pair : patterns)
+        this->add(pair.first, pair.second);
+
+    this->compile();
+}
+
+
+void multi_replacer::add(std::string_view from, std::string_view to)
+{
+    if (from.empty())
+        CIX_THROW_BADARG("multi_replacer: empty pattern (#{})", m_pending.size());
+
+    m_pending.emplace_back(from, to);
+}
+
+
+void multi_replacer::compile()
+{
+    if (m_pending.size() >= no_match)
+        CIX_THROW_LENGTH("multi_replacer: too many patterns ({})", m_pending.size());
+
+    // map bytes that appear in patterns to classes [1, N], all others to class
+    // 0, unless all the 256 values are used
+    {
+        std::array<bool, 256> used = {};
+        size_type count = 0;
+
+        for (const auto& [from, to] : m_pending)
+        {
+            for (const auto c : from)
+            {
+                auto& flag = used[static_cast<std::uint8_t>(c)];
+                count += flag ? 0 : 1;
+                flag = true;
+            }
+        }
+
+        std::uint8_t next_class = (count < 256) ? 1 : 0;
+
+        for (size_type b = 0; b < 256; ++b)
+            m_classes[b] = used[b] ? next_class++ : 0;
+
+        m_classes_count = (count < 256) ? count + 1 : 256;
+    }
+
+    // build the trie, 0 being the root
+    // a transition to state 0 means "none" at this stage since the root cannot
+    // be the child of a state
+    const auto new_state = [this](std::uint32_t depth) -> std::uint32_t {
+        const auto state = static_cast<std::uint32_t>(m_out.size());
+        m_delta.resize(m_delta.size() + m_classes_count, 0);
+        m_depth.push_back(depth);
+        m_out.push_back(no_match);
+        return state;
+    };
+
+    new_state(0);
+
+    for (const auto& [from, to] : m_pending)
+    {
+        std::uint32_t state = 0;
+
+        for (const auto c : from)
+        {
+            auto next = this->next(state, c);
+
+            if (!next)
+            {
+                next = new_state(m_depth[state] + 1);
+                m_delta[
+                    state * m_classes_count +
+                    m_classes[static_cast<std::uint8_t>(c)]] = next;
+            }
+
+            state = next;
+        }
+
+        if (m_out[state] == no_match)
+        {
+            m_out[state] = static_cast<std::uint32_t>(m_entries.size());
+            m_entries.push_back({ from.size(), 0, 0 });
+        }
+
+        // last replacement wins
+        auto& entry = m_entries[m_out[state]];
+        entry.to_offset = m_replacements.size();
+        entry.to_size = to.size();
+        m_replacements.append(to);
+    }
+
+    m_pending.clear();
+    m_pending.shrink_to_fit();
+
+    // Resolve failure links in breadth-first order, so that the transitions
+    // of the failure state of a state are complete by the time the state is
+    // visited. Missing transitions are replaced by those of the failure
+    // state, turning the trie into a DFA.
+    //
+    // A state that is not terminal outputs the longest pattern that ends
+    // with its prefix, if any, which is the output of its failure state.
+    std::vector<std::uint32_t> fail(m_out.size(), 0);
+    std::vector<std::uint32_t> queue;
+
+    queue.reserve(m_out.size());
+
+    for (size_type cls = 0; cls < m_classes_count; ++cls)
+    {
+        if (const auto child = m_delta[cls])
+            queue.push_back(child);
+    }
+
+    for (size_type idx = 0; idx < queue.size(); ++idx)
+    {
+        const auto state = queue[idx];
+        const auto failure = fail[state];
+
+        if (m_out[state] == no_match)
+            m_out[state] = m_out[failure];
+
+        for (size_type cls = 0; cls < m_classes_count; ++cls)
+        {
+            auto& next = m_delta[state * m_classes_count + cls];
+            const auto fallback = m_delta[failure * m_classes_count + cls];
+
+            if (next)
+            {
+                fail[next] = fallback;
+                queue.push_back(next);
+            }
+            else
+            {
+                next = fallback;
+            }
+        }
+    }
+}
+
+
+bool multi_replacer::contains_any(std::string_view input) const noexcept
+{
+    if (m_out.empty())
+        return false;
+
+    std::uint32_t state = 0;
+
+    for (const auto c : input)
+    {
+        state = this->next(state, c);
+
+        if (m_out[state] != no_match)
+            return true;
+    }
+
+    return false;
+}
+
+
+void multi_replacer::replace_to(std::string_view input, std::string& out) const
+{
+    if (m_out.empty())
+    {
+        out.append(input);
+        return;
+    }
+
+    // Leftmost-longest: a match is committed once no match that starts at or
+    // before it can still be found, i.e. once the prefix currently matched by
+    // the automaton starts after it. Scanning then resumes from the root
+    // right after the match.
+    const auto size = input.size();
+    size_type copied = 0;  // input is copied to output up to this offset
+    size_type pos = 0;
+    std::uint32_t state = 0;
+    std::uint32_t best = no_match;
+    size_type best_start = 0;
+
+    for (;;)
+    {
+        if (pos < size)
+        {
+            state = this->next(state, input[pos++]);
+
+            if (const auto match = m_out[state]; match != no_match)
+            {
+                const auto start = pos - m_entries[match].from_size;
+
+                // the longest pattern ending here is the one that starts
+                // first, so that only a strictly lower start can be better,
+                // or the same start with a longer pattern
+                if (best == no_match ||
+                    start < best_start ||
+                    (start == best_start &&
+                        m_entries[match].from_size > m_entries[best].from_size))
+                {
+                    best = match;
+                    best_start = start;
+                }
+            }
+
+            if (best == no_match || best_start >= pos - m_depth[state])
+                continue;
+        }
+        else if (best == no_match)
+        {
+            break;
+        }
+
+        // commit best match
+        const auto& entry = m_entries[best];
+
+        out.append(input.substr(copied, best_start - copied));
+        out.append(m_replacements, entry.to_offset, entry.to_size);
+
+        copied = best_start + entry.from_size;
+        pos = copied;
+        state = 0;
+        best = no_match;
+    }
+
+    out.append(input.substr(copied));
+}
+
+
+std::string multi_replacer::replace(std::string_view input) const
+{
+    std::string out;
+
+    out.reserve(input.size());
+    this->replace_to(input, out);
+
+    return out;
+}
+
+}  // namespace string
+}  // namespace cix
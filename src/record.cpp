@@ -0,0 +1,289 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+
+namespace detail::record
+{
+    inline std::uint8_t* write_varint(std::uint8_t* p, std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            *p++ = static_cast<std::uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        *p++ = static_cast<std::uint8_t>(value);
+        return p;
+    }
+
+    // returns the number of bytes read, or 0 on error or truncated input
+    inline std::size_t read_varint(
+        const std::uint8_t* p, std::size_t avail, std::uint64_t& value)
+    {
+        const auto max_len = std::min<std::size_t>(
+            avail, cix::record::max_varint_size);
+
+        value = 0;
+
+        for (std::size_t idx = 0; idx < max_len; ++idx)
+        {
+            value |= static_cast<std::uint64_t>(p[idx] & 0x7f) << (7 * idx);
+            if (!(p[idx] & 0x80))
+                return idx + 1;
+        }
+
+        return 0;
+    }
+
+    inline void write32le(std::uint8_t* p, std::uint32_t v)
+    {
+        p[0] = static_cast<std::uint8_t>(v);
+        p[1] = static_cast<std::uint8_t>(v >> 8);
+        p[2] = static_cast<std::uint8_t>(v >> 16);
+        p[3] = static_cast<std::uint8_t>(v >> 24);
+    }
+
+    inline std::uint32_t read32le(const std::uint8_t* p)
+    {
+        return
+            static_cast<std::uint32_t>(p[0]) |
+            (static_cast<std::uint32_t>(p[1]) << 8) |
+            (static_cast<std::uint32_t>(p[2]) << 16) |
+            (static_cast<std::uint32_t>(p[3]) << 24);
+    }
+}
+
+
+
+//******************************************************************************
+
+
+
+record_writer::record_writer(memstream& stream)
+    : m_stream(stream)
+    , m_count{0}
+{
+}
+
+
+memstream& record_writer::stream()
+{
+    return m_stream;
+}
+
+
+record_writer::size_type record_writer::count() const
+{
+    return m_count;
+}
+
+
+record_writer& record_writer::write(const void* payload, size_type size)
+{
+    using namespace detail::record;
+
+    if (!payload && size)
+        CIX_THROW_BADARG("null record payload");
+
+    if (size > std::numeric_limits<std::uint32_t>::max())
+        CIX_THROW_LENGTH("record too big ({} bytes)", size);
+
+    auto* const out = m_stream.prepare_write(record::max_overhead + size);
+    if (!out)
+        CIX_THROW_LOGIC("record_writer: read-only stream");
+
+    auto* p = out;
+
+    *p++ = record::magic[0];
+    *p++ = record::magic[1];
+
+    auto* const crc_begin = p;
+
+    p = write_varint(p, size);
+
+    if (size > 0)
+    {
+        std::memcpy(p, payload, size);
+        p += size;
+    }
+
+    write32le(p, crc32::crc32(crc_begin, p));
+    p += sizeof(std::uint32_t);
+
+    m_stream.finalize_write(static_cast<size_type>(p - out));
+    ++m_count;
+
+    return *this;
+}
+
+
+record_writer& record_writer::write(const record_view& payload)
+{
+    return this->write(payload.data, payload.size);
+}
+
+
+
+//******************************************************************************
+
+
+
+record_reader::record_reader(
+        const void* data, size_type size,
+        size_type max_record_size)
+    : m_data{reinterpret_cast<const std::uint8_t*>(data)}
+    , m_size{data ? size : 0}
+    , m_max_record_size{max_record_size}
+    , m_pos{0}
+    , m_count{0}
+    , m_corrupted{0}
+    , m_skipped{0}
+{
+    assert(data || !size);
+}
+
+
+record_reader::record_reader(
+        const memstream& stream,
+        size_type max_record_size)
+    : record_reader(
+        stream.empty() ? nullptr : stream.data(),
+        stream.size(),
+        max_record_size)
+{
+}
+
+
+bool record_reader::next(record_view& out)
+{
+    while (m_pos < m_size)
+    {
+        size_type frame_size = 0;
+        auto res = this->parse(m_pos, out, frame_size);
+
+        if (res == parse_result::valid)
+        {
+            m_pos += frame_size;
+            ++m_count;
+            return true;
+        }
+
+        // The declared length of the frame goes past the end of the buffer.
+        // Trust it, the frame is most likely not fully written yet, and any
+        // magic bytes found further may just be part of its payload.
+        if (res == parse_result::incomplete)
+            return false;
+
+        this->skip();
+    }
+
+    return false;
+}
+
+
+void record_reader::skip()
+{
+    if (m_pos >= m_size)
+        return;
+
+    const auto next_pos = this->find_magic(m_pos + 1);
+
+    ++m_corrupted;
+    m_skipped += next_pos - m_pos;
+    m_pos = next_pos;
+}
+
+
+record_reader::size_type record_reader::tell() const
+{
+    return m_pos;
+}
+
+
+record_reader::size_type record_reader::count() const
+{
+    return m_count;
+}
+
+
+record_reader::size_type record_reader::corrupted() const
+{
+    return m_corrupted;
+}
+
+
+record_reader::size_type record_reader::skipped_bytes() const
+{
+    return m_skipped;
+}
+
+
+record_reader::parse_result record_reader::parse(
+    size_type pos, record_view& out, size_type& frame_size) const
+{
+    using namespace detail::record;
+
+    assert(pos <= m_size);
+
+    const auto* const begin = m_data + pos;
+    const auto avail = m_size - pos;
+
+    if (avail < sizeof(record::magic))
+    {
+        return (begin[0] == record::magic[0]) ?
+            parse_result::incomplete : parse_result::corrupted;
+    }
+
+    if (begin[0] != record::magic[0] || begin[1] != record::magic[1])
+        return parse_result::corrupted;
+
+    const auto* const crc_begin = begin + sizeof(record::magic);
+    std::uint64_t length;
+    const auto varint_size = read_varint(
+        crc_begin, avail - sizeof(record::magic), length);
+
+    if (!varint_size)
+    {
+        return (avail - sizeof(record::magic) < record::max_varint_size) ?
+            parse_result::incomplete : parse_result::corrupted;
+    }
+
+    if (length > m_max_record_size)
+        return parse_result::corrupted;
+
+    const auto overhead =
+        sizeof(record::magic) + varint_size + sizeof(std::uint32_t);
+
+    if (avail < overhead || length > avail - overhead)
+        return parse_result::incomplete;
+
+    const auto* const payload = crc_begin + varint_size;
+    const auto* const crc_end = payload + length;
+
+    if (read32le(crc_end) != crc32::crc32(crc_begin, crc_end))
+        return parse_result::corrupted;
+
+    out.data = payload;
+    out.size = static_cast<size_type>(length);
+    frame_size = overhead + static_cast<size_type>(length);
+
+    return parse_result::valid;
+}
+
+
+record_reader::size_type record_reader::find_magic(size_type from) const
+{
+    if (from >= m_size)
+        return m_size;
+
+    const auto* p = reinterpret_cast<const std::uint8_t*>(
+        std::memchr(m_data + from, record::magic[0], m_size - from));
+
+    return p ? static_cast<size_type>(p - m_data) : m_size;
+}
+
+}  // namespace cix
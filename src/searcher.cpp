@@ -0,0 +1,153 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+namespace string {
+
+namespace detail::searcher
+{
+    using cix::detail::lowest_bit;
+
+
+    // Compare the first and the last characters of the needle with W
+    // consecutive positions of the haystack at once, then check the
+    // candidates in full. Return npos if not found before *end*, the last
+    // position for which W candidates can be loaded, and update *pos* so
+    // that the caller can search the remaining positions.
+#if CIX_HAS_AVX2
+    inline size_type find_avx2(
+        const std::uint8_t* haystack, size_type& pos, size_type end,
+        const std::uint8_t* needle, size_type needle_size) noexcept
+    {
+        const auto last = needle_size - 1;
+        const auto first_c = _mm256_set1_epi8(static_cast<char>(needle[0]));
+        const auto last_c = _mm256_set1_epi8(static_cast<char>(needle[last]));
+
+        for (; pos + 32 <= end; pos += 32)
+        {
+            const auto block_first = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(haystack + pos));
+            const auto block_last = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(haystack + pos + last));
+
+            auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                _mm256_and_si256(
+                    _mm256_cmpeq_epi8(block_first, first_c),
+                    _mm256_cmpeq_epi8(block_last, last_c))));
+
+            while (mask)
+            {
+                const auto candidate = pos + lowest_bit(mask);
+
+                if (needle_size <= 2 ||
+                    0 == std::memcmp(
+                        haystack + candidate + 1, needle + 1, needle_size - 2))
+                {
+                    return candidate;
+                }
+
+                mask &= mask - 1;
+            }
+        }
+
+        return npos;
+    }
+#endif
+
+
+#if CIX_HAS_SSE2
+    inline size_type find_sse2(
+        const std::uint8_t* haystack, size_type& pos, size_type end,
+        const std::uint8_t* needle, size_type needle_size) noexcept
+    {
+        const auto last = needle_size - 1;
+        const auto first_c = _mm_set1_epi8(static_cast<char>(needle[0]));
+        const auto last_c = _mm_set1_epi8(static_cast<char>(needle[last]));
+
+        for (; pos + 16 <= end; pos += 16)
+        {
+            const auto block_first = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(haystack + pos));
+            const auto block_last = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(haystack + pos + last));
+
+            auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(
+                _mm_and_si128(
+                    _mm_cmpeq_epi8(block_first, first_c),
+                    _mm_cmpeq_epi8(block_last, last_c))));
+
+            while (mask)
+            {
+                const auto candidate = pos + lowest_bit(mask);
+
+                if (needle_size <= 2 ||
+                    0 == std::memcmp(
+                        haystack + candidate + 1, needle + 1, needle_size - 2))
+                {
+                    return candidate;
+                }
+
+                mask &= mask - 1;
+            }
+        }
+
+        return npos;
+    }
+#endif
+
+
+    size_type find_bytes(
+        const void* haystack_, size_type size,
+        const void* needle_, size_type needle_size,
+        const skip_table& skip) noexcept
+    {
+        const auto* haystack = static_cast<const std::uint8_t*>(haystack_);
+        const auto* needle = static_cast<const std::uint8_t*>(needle_);
+
+        assert(needle_size > 0);
+
+        if (needle_size > size)
+            return npos;
+
+        if (needle_size == 1)
+        {
+            const auto* p = std::memchr(haystack, needle[0], size);
+            return p ? static_cast<const std::uint8_t*>(p) - haystack : npos;
+        }
+
+        // number of candidate positions
+        const auto end = size - needle_size + 1;
+        size_type pos = 0;
+
+    #if CIX_HAS_AVX2
+        {
+            const auto res = find_avx2(haystack, pos, end, needle, needle_size);
+            if (res != npos)
+                return res;
+        }
+    #endif
+
+    #if CIX_HAS_SSE2
+        {
+            const auto res = find_sse2(haystack, pos, end, needle, needle_size);
+            if (res != npos)
+                return res;
+        }
+    #endif
+
+        // remaining positions
+        const auto res = bmh_find(
+            static_cast<const char*>(haystack_) + pos, size - pos,
+            static_cast<const char*>(needle_), needle_size,
+            skip);
+
+        return (res == npos) ? npos : pos + res;
+    }
+}  // namespace detail::searcher
+
+}  // namespace string
+}  // namespace cix
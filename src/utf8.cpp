@@ -0,0 +1,772 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+namespace string {
+
+namespace detail::utf8
+{
+    static constexpr char32_t replacement_char = 0xfffd;
+
+    // number of bytes (when widening), or code units (when narrowing),
+    // processed at once by the ASCII fast paths
+    static constexpr std::ptrdiff_t block_size = 32;
+    static constexpr std::ptrdiff_t narrow_block_size = 16;
+
+
+    // Decode the multi-byte sequence at *p*, *p* being a non-ASCII byte.
+    // Return the length of the sequence, or the negated length of its maximal
+    // invalid subpart, which is what Unicode recommends to replace with a
+    // single U+FFFD (see "U+FFFD Substitution of Maximal Subparts").
+    inline int decode(
+        const std::uint8_t* p,
+        const std::uint8_t* end,
+        char32_t& cp) noexcept
+    {
+        const auto b0 = p[0];
+        std::uint8_t lo = 0x80;
+        std::uint8_t hi = 0xbf;
+        int len;
+
+        if (b0 >= 0xc2 && b0 <= 0xdf)
+        {
+            len = 2;
+            cp = b0 & 0x1f;
+        }
+        else if (b0 >= 0xe0 && b0 <= 0xef)
+        {
+            len = 3;
+            cp = b0 & 0x0f;
+            if (b0 == 0xe0)
+                lo = 0xa0;  // overlong
+            else if (b0 == 0xed)
+                hi = 0x9f;  // surrogates
+        }
+        else if (b0 >= 0xf0 && b0 <= 0xf4)
+        {
+            len = 4;
+            cp = b0 & 0x07;
+            if (b0 == 0xf0)
+                lo = 0x90;  // overlong
+            else if (b0 == 0xf4)
+                hi = 0x8f;  // > U+10FFFF
+        }
+        else
+        {
+            return -1;
+        }
+
+        for (int idx = 1; idx < len; ++idx)
+        {
+            if (p + idx >= end || p[idx] < lo || p[idx] > hi)
+                return -idx;
+
+            cp = (cp << 6) | (p[idx] & 0x3f);
+            lo = 0x80;
+            hi = 0xbf;
+        }
+
+        return len;
+    }
+
+
+    // *Unit* is a UTF-16 code unit if 2-byte wide, UTF-32 otherwise
+    template <typename Unit>
+    inline void put_wide(Unit*& out, char32_t cp) noexcept
+    {
+        if constexpr (sizeof(Unit) == 2)
+        {
+            if (cp >= 0x10000)
+            {
+                cp -= 0x10000;
+                *out++ = static_cast<Unit>(0xd800 + (cp >> 10));
+                *out++ = static_cast<Unit>(0xdc00 + (cp & 0x3ff));
+                return;
+            }
+        }
+
+        *out++ = static_cast<Unit>(cp);
+    }
+
+
+    inline void put_utf8(char*& out, char32_t cp) noexcept
+    {
+        if (cp < 0x80)
+        {
+            *out++ = static_cast<char>(cp);
+        }
+        else if (cp < 0x800)
+        {
+            *out++ = static_cast<char>(0xc0 | (cp >> 6));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+        }
+        else if (cp < 0x10000)
+        {
+            *out++ = static_cast<char>(0xe0 | (cp >> 12));
+            *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+        }
+        else
+        {
+            *out++ = static_cast<char>(0xf0 | (cp >> 18));
+            *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+        }
+    }
+
+
+    // widen block_size bytes at *p* if they are all ASCII
+    template <typename Unit>
+    inline bool widen_ascii(const std::uint8_t* p, Unit* out) noexcept
+    {
+    #if CIX_HAS_SSE2
+        const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+
+        if (_mm_movemask_epi8(_mm_or_si128(a, b)))
+            return false;
+
+        const auto zero = _mm_setzero_si128();
+        const __m128i units16[4] = {
+            _mm_unpacklo_epi8(a, zero), _mm_unpackhi_epi8(a, zero),
+            _mm_unpacklo_epi8(b, zero), _mm_unpackhi_epi8(b, zero) };
+
+        auto* dest = reinterpret_cast<__m128i*>(out);
+
+        for (int idx = 0; idx < 4; ++idx)
+        {
+            if constexpr (sizeof(Unit) == 2)
+            {
+                _mm_storeu_si128(dest + idx, units16[idx]);
+            }
+            else
+            {
+                _mm_storeu_si128(dest + 2 * idx, _mm_unpacklo_epi16(units16[idx], zero));
+                _mm_storeu_si128(dest + 2 * idx + 1, _mm_unpackhi_epi16(units16[idx], zero));
+            }
+        }
+
+        return true;
+    #else
+        std::uint64_t words[block_size / 8];
+        std::memcpy(words, p, sizeof(words));
+
+        if ((words[0] | words[1] | words[2] | words[3]) & 0x8080808080808080ull)
+            return false;
+
+        for (std::ptrdiff_t idx = 0; idx < block_size; ++idx)
+            out[idx] = static_cast<Unit>(p[idx]);
+
+        return true;
+    #endif
+    }
+
+
+    // narrow narrow_block_size code units at *p* if they are all ASCII
+    template <typename Unit>
+    inline bool narrow_ascii(const Unit* p, char* out) noexcept
+    {
+    #if CIX_HAS_SSE2
+        const auto* src = reinterpret_cast<const __m128i*>(p);
+        const auto zero = _mm_setzero_si128();
+
+        if constexpr (sizeof(Unit) == 2)
+        {
+            const auto a = _mm_loadu_si128(src);
+            const auto b = _mm_loadu_si128(src + 1);
+            const auto high = _mm_and_si128(
+                _mm_or_si128(a, b), _mm_set1_epi16(static_cast<short>(0xff80)));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xffff)
+                return false;
+
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(out), _mm_packus_epi16(a, b));
+        }
+        else
+        {
+            const auto a = _mm_loadu_si128(src);
+            const auto b = _mm_loadu_si128(src + 1);
+            const auto c = _mm_loadu_si128(src + 2);
+            const auto d = _mm_loadu_si128(src + 3);
+            const auto high = _mm_and_si128(
+                _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)),
+                _mm_set1_epi32(static_cast<int>(0xffffff80)));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xffff)
+                return false;
+
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(out),
+                _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+        }
+
+        return true;
+    #else
+        for (std::ptrdiff_t idx = 0; idx < narrow_block_size; ++idx)
+        {
+            if (static_cast<std::make_unsigned_t<Unit>>(p[idx]) >= 0x80)
+                return false;
+        }
+
+        for (std::ptrdiff_t idx = 0; idx < narrow_block_size; ++idx)
+            out[idx] = static_cast<char>(p[idx]);
+
+        return true;
+    #endif
+    }
+
+
+    template <typename Unit>
+    std::basic_string<Unit> from_utf8(const char* src, size_type len, bool strict)
+    {
+        if (!src || !len)
+            return {};
+
+        // single pass: a byte never produces more than one code unit
+        std::basic_string<Unit> dest(len, 0);
+
+        const auto* p = reinterpret_cast<const std::uint8_t*>(src);
+        const auto* const end = p + len;
+        auto* out = dest.data();
+
+        while (p < end)
+        {
+            if (end - p >= block_size && widen_ascii(p, out))
+            {
+                p += block_size;
+                out += block_size;
+                continue;
+            }
+
+            // Slow path up to the next block. Last sequence may cross
+            // block_end.
+            const auto* const block_end = p + std::min(block_size, end - p);
+
+            while (p < block_end)
+            {
+                if (*p < 0x80)
+                {
+                    *out++ = static_cast<Unit>(*p++);
+                    continue;
+                }
+
+                char32_t cp;
+                const auto res = decode(p, end, cp);
+
+                if (res > 0)
+                {
+                    put_wide(out, cp);
+                    p += res;
+                }
+                else if (strict)
+                {
+                    return {};
+                }
+                else
+                {
+                    put_wide(out, replacement_char);
+                    p += -res;
+                }
+            }
+        }
+
+        dest.resize(static_cast<size_type>(out - dest.data()));
+
+        return dest;
+    }
+
+
+    template <typename Unit>
+    std::string to_utf8(const Unit* src, size_type len, bool strict)
+    {
+        typedef std::make_unsigned_t<Unit> unit_type;
+
+        static constexpr bool is_utf16 = sizeof(Unit) == 2;
+        static constexpr size_type max_ratio = is_utf16 ? 3 : 4;
+
+        if (!src || !len)
+            return {};
+
+        // single pass: a UTF-16 code unit never produces more than 3 bytes
+        // (a surrogate pair produces 4), and a UTF-32 one more than 4
+        if (len > std::string().max_size() / max_ratio)
+            CIX_THROW_LENGTH("to_utf8: input too long ({} code units)", len);
+
+        std::string dest(len * max_ratio, 0);
+
+        const auto* p = src;
+        const auto* const end = src + len;
+        auto* out = dest.data();
+
+        while (p < end)
+        {
+            if (end - p >= narrow_block_size && narrow_ascii(p, out))
+            {
+                p += narrow_block_size;
+                out += narrow_block_size;
+                continue;
+            }
+
+            const auto* const block_end = p + std::min(narrow_block_size, end - p);
+
+            while (p < block_end)
+            {
+                char32_t cp = static_cast<unit_type>(*p++);
+                bool valid = true;
+
+                if (cp < 0x80)
+                {
+                    *out++ = static_cast<char>(cp);
+                    continue;
+                }
+
+                if constexpr (is_utf16)
+                {
+                    if (cp >= 0xd800 && cp <= 0xdbff &&
+                        p < end &&
+                        static_cast<unit_type>(*p) >= 0xdc00 &&
+                        static_cast<unit_type>(*p) <= 0xdfff)
+                    {
+                        cp = 0x10000 + ((cp - 0xd800) << 10) +
+                            (static_cast<unit_type>(*p++) - 0xdc00);
+                    }
+                    else if (cp >= 0xd800 && cp <= 0xdfff)
+                    {
+                        valid = false;  // unpaired surrogate
+                    }
+                }
+                else
+                {
+                    if ((cp >= 0xd800 && cp <= 0xdfff) || cp > 0x10ffff)
+                        valid = false;
+                }
+
+                if (valid)
+                    put_utf8(out, cp);
+                else if (strict)
+                    return {};
+                else
+                    put_utf8(out, replacement_char);
+            }
+        }
+
+        dest.resize(static_cast<size_type>(out - dest.data()));
+
+        return dest;
+    }
+
+    inline bool is_continuation(std::uint8_t b) noexcept
+    {
+        return (b & 0xc0) == 0x80;
+    }
+
+
+    // Validate from *p* to *end* one sequence at a time, ASCII being skipped
+    // 16 bytes at a time with SSE2, 8 otherwise, and add the number of code
+    // points to *count*. Return the offset from *begin* of the first invalid
+    // sequence, or npos.
+    inline size_type validate_scalar(
+        const std::uint8_t* begin,
+        const std::uint8_t* p,
+        const std::uint8_t* end,
+        size_type& count) noexcept
+    {
+        while (p < end)
+        {
+        #if CIX_HAS_SSE2
+            // skip ASCII up to the first non-ASCII byte of the next 16, if any
+            if (end - p >= 16)
+            {
+                const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+                const auto ascii = mask ? cix::detail::lowest_bit(mask) : 16u;
+
+                p += ascii;
+                count += ascii;
+
+                if (!mask)
+                    continue;
+            }
+        #else
+            if (end - p >= 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, p, sizeof(word));
+
+                if (!(word & 0x8080808080808080ull))
+                {
+                    p += 8;
+                    count += 8;
+                    continue;
+                }
+            }
+        #endif
+
+            if (*p < 0x80)
+            {
+                ++p;
+            }
+            else
+            {
+                char32_t cp;
+                const auto res = decode(p, end, cp);
+
+                if (res <= 0)
+                    return static_cast<size_type>(p - begin);
+
+                p += res;
+            }
+
+            ++count;
+        }
+
+        return npos;
+    }
+
+
+    // Continue with validate_scalar() from *p*, the data before *p* being
+    // valid except for the last sequence, which may be truncated. The
+    // beginning of this sequence is less than 4 bytes away, and its lead byte
+    // has been counted already.
+    inline size_type resume_scalar(
+        const std::uint8_t* begin,
+        const std::uint8_t* p,
+        const std::uint8_t* end,
+        size_type& count) noexcept
+    {
+        auto* start = p - std::min<std::ptrdiff_t>(3, p - begin);
+
+        // skip the tail of a complete sequence
+        while (start < p && is_continuation(*start))
+            ++start;
+
+        for (auto* q = start; q < p; ++q)
+            count -= is_continuation(*q) ? 0 : 1;
+
+        return validate_scalar(begin, start, end, count);
+    }
+
+
+#if CIX_HAS_SSSE3
+    // Vectorized validation from Keiser and Lemire, "Validating UTF-8 In Less
+    // Than One Instruction Per Byte" (2021).
+    //
+    // Every pair of consecutive bytes is classified with three 16-entry
+    // tables, indexed by the high and low nibbles of the first byte, and by
+    // the high nibble of the second byte. Each bit of an entry stands for an
+    // error the pair may be part of, so that the pair is invalid if the three
+    // entries have a bit in common. The third and the fourth bytes of a
+    // sequence are checked separately.
+    enum : std::uint8_t
+    {
+        too_short = 1 << 0,       // lead byte not followed by a continuation
+        too_long = 1 << 1,        // continuation byte after an ASCII one
+        overlong_3 = 1 << 2,      // 11100000 100_____
+        too_large = 1 << 3,       // 11110100 1001____ and above
+        surrogate = 1 << 4,       // 11101101 101_____
+        overlong_2 = 1 << 5,      // 1100000_ 10______
+        too_large_1000 = 1 << 6,  // 11110101 1000____ and above
+        overlong_4 = 1 << 6,      // 11110000 1000____
+        two_conts = 1 << 7,       // continuation byte after another one
+        carry = too_short | too_long | two_conts,
+    };
+
+    alignas(16) static constexpr std::uint8_t byte_1_high[16] = {
+        // 0_______: ASCII
+        too_long, too_long, too_long, too_long,
+        too_long, too_long, too_long, too_long,
+        // 10______: continuation
+        two_conts, two_conts, two_conts, two_conts,
+        // 1100____, 1101____: 2-byte lead
+        too_short | overlong_2,
+        too_short,
+        // 1110____: 3-byte lead
+        too_short | overlong_3 | surrogate,
+        // 1111____: 4-byte lead
+        too_short | too_large | too_large_1000 | overlong_4 };
+
+    alignas(16) static constexpr std::uint8_t byte_1_low[16] = {
+        carry | overlong_3 | overlong_2 | overlong_4,  // ____0000
+        carry | overlong_2,                            // ____0001
+        carry,                                         // ____001_
+        carry,
+        carry | too_large,                             // ____0100
+        carry | too_large | too_large_1000,            // ____0101
+        carry | too_large | too_large_1000,            // ____011_
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,            // ____1___
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000 | surrogate,  // ____1101
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000 };
+
+    alignas(16) static constexpr std::uint8_t byte_2_high[16] = {
+        // ________ 0_______: ASCII
+        too_short, too_short, too_short, too_short,
+        too_short, too_short, too_short, too_short,
+        // ________ 1000____
+        too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+        // ________ 1001____
+        too_long | overlong_2 | two_conts | overlong_3 | too_large,
+        // ________ 101_____
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        // ________ 11______: lead byte
+        too_short, too_short, too_short, too_short };
+
+    // a block ends with a truncated sequence if one of its last 3 bytes is
+    // above the matching bound
+    static constexpr std::uint8_t incomplete_max[32] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xef, 0xdf, 0xbf };
+
+
+    struct ssse3_ops
+    {
+        typedef __m128i vec;
+
+        static constexpr std::ptrdiff_t width = 16;
+
+        static vec zero() noexcept { return _mm_setzero_si128(); }
+        static vec set1(std::uint8_t b) noexcept { return _mm_set1_epi8(static_cast<char>(b)); }
+        static vec load(const std::uint8_t* p) noexcept
+        {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        }
+        static vec table(const std::uint8_t* t) noexcept
+        {
+            return _mm_load_si128(reinterpret_cast<const __m128i*>(t));
+        }
+        static vec lookup(vec t, vec idx) noexcept { return _mm_shuffle_epi8(t, idx); }
+        static vec shr4(vec v) noexcept { return _mm_srli_epi16(v, 4); }
+        static vec and_(vec a, vec b) noexcept { return _mm_and_si128(a, b); }
+        static vec or_(vec a, vec b) noexcept { return _mm_or_si128(a, b); }
+        static vec xor_(vec a, vec b) noexcept { return _mm_xor_si128(a, b); }
+        static vec subs(vec a, vec b) noexcept { return _mm_subs_epu8(a, b); }
+        static bool is_ascii(vec v) noexcept { return !_mm_movemask_epi8(v); }
+        static bool is_zero(vec v) noexcept
+        {
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero())) == 0xffff;
+        }
+
+        // bytes of *prev* and *input* shifted by N bytes
+        template <int N>
+        static vec prev(vec input, vec prev) noexcept
+        {
+            return _mm_alignr_epi8(input, prev, 16 - N);
+        }
+
+        // add the number of bytes of *v* that are not continuation bytes to
+        // the 64-bit lanes of *acc*
+        static vec count_leads(vec acc, vec v) noexcept
+        {
+            const auto leads = _mm_cmpgt_epi8(v, _mm_set1_epi8(-65));
+            return _mm_add_epi64(acc, _mm_sad_epu8(_mm_sub_epi8(zero(), leads), zero()));
+        }
+
+        static size_type sum64(vec v) noexcept
+        {
+            alignas(16) std::uint64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+            return static_cast<size_type>(lanes[0] + lanes[1]);
+        }
+    };
+#endif  // CIX_HAS_SSSE3
+
+
+#if CIX_HAS_AVX2
+    struct avx2_ops
+    {
+        typedef __m256i vec;
+
+        static constexpr std::ptrdiff_t width = 32;
+
+        static vec zero() noexcept { return _mm256_setzero_si256(); }
+        static vec set1(std::uint8_t b) noexcept { return _mm256_set1_epi8(static_cast<char>(b)); }
+        static vec load(const std::uint8_t* p) noexcept
+        {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        }
+        static vec table(const std::uint8_t* t) noexcept
+        {
+            return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t)));
+        }
+        static vec lookup(vec t, vec idx) noexcept { return _mm256_shuffle_epi8(t, idx); }
+        static vec shr4(vec v) noexcept { return _mm256_srli_epi16(v, 4); }
+        static vec and_(vec a, vec b) noexcept { return _mm256_and_si256(a, b); }
+        static vec or_(vec a, vec b) noexcept { return _mm256_or_si256(a, b); }
+        static vec xor_(vec a, vec b) noexcept { return _mm256_xor_si256(a, b); }
+        static vec subs(vec a, vec b) noexcept { return _mm256_subs_epu8(a, b); }
+        static bool is_ascii(vec v) noexcept { return !_mm256_movemask_epi8(v); }
+        static bool is_zero(vec v) noexcept { return _mm256_testz_si256(v, v) != 0; }
+
+        template <int N>
+        static vec prev(vec input, vec prev) noexcept
+        {
+            // shuffles work within 128-bit lanes, hence the permutation
+            return _mm256_alignr_epi8(
+                input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - N);
+        }
+
+        static vec count_leads(vec acc, vec v) noexcept
+        {
+            const auto leads = _mm256_cmpgt_epi8(v, _mm256_set1_epi8(-65));
+            return _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_sub_epi8(zero(), leads), zero()));
+        }
+
+        static size_type sum64(vec v) noexcept
+        {
+            alignas(32) std::uint64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+            return static_cast<size_type>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+        }
+    };
+#endif  // CIX_HAS_AVX2
+
+
+#if CIX_HAS_SSSE3
+    // Check whole blocks of Ops::width bytes, and let resume_scalar() find the
+    // exact offset of the first error, if any, and deal with the remaining
+    // bytes. Code points are counted only if *Count* is true.
+    template <typename Ops, bool Count>
+    size_type validate_simd(
+        const std::uint8_t* begin,
+        const std::uint8_t* end,
+        size_type& count) noexcept
+    {
+        typedef typename Ops::vec vec;
+
+        const auto b1_high = Ops::table(byte_1_high);
+        const auto b1_low = Ops::table(byte_1_low);
+        const auto b2_high = Ops::table(byte_2_high);
+        const auto nibble = Ops::set1(0x0f);
+        const auto msb = Ops::set1(0x80);
+        const auto third_min = Ops::set1(0xe0 - 0x80);
+        const auto fourth_min = Ops::set1(0xf0 - 0x80);
+        const auto incomplete = Ops::load(incomplete_max + 32 - Ops::width);
+
+        vec prev_input = Ops::zero();
+        vec prev_incomplete = Ops::zero();
+        vec leads = Ops::zero();
+        const auto* p = begin;
+
+        for (; end - p >= Ops::width; p += Ops::width)
+        {
+            const auto input = Ops::load(p);
+            const auto ascii = Ops::is_ascii(input);
+            vec error;
+
+            if (ascii)
+            {
+                // only a sequence truncated by the previous block can fail
+                error = prev_incomplete;
+                prev_incomplete = Ops::zero();
+            }
+            else
+            {
+                const auto prev1 = Ops::template prev<1>(input, prev_input);
+
+                const auto special = Ops::and_(
+                    Ops::and_(
+                        Ops::lookup(b1_high, Ops::and_(Ops::shr4(prev1), nibble)),
+                        Ops::lookup(b1_low, Ops::and_(prev1, nibble))),
+                    Ops::lookup(b2_high, Ops::and_(Ops::shr4(input), nibble)));
+
+                // the high bit is set where a third or a fourth byte of a
+                // sequence is expected, which must be a continuation byte,
+                // i.e. a two_conts error with the classification above
+                const auto must_be_cont = Ops::or_(
+                    Ops::subs(Ops::template prev<2>(input, prev_input), third_min),
+                    Ops::subs(Ops::template prev<3>(input, prev_input), fourth_min));
+
+                error = Ops::xor_(Ops::and_(must_be_cont, msb), special);
+                prev_incomplete = Ops::subs(input, incomplete);
+            }
+
+            if (!Ops::is_zero(error))
+                break;
+
+            if constexpr (Count)
+            {
+                if (ascii)
+                    count += Ops::width;
+                else
+                    leads = Ops::count_leads(leads, input);
+            }
+
+            prev_input = input;
+        }
+
+        if constexpr (Count)
+            count += Ops::sum64(leads);
+
+        return resume_scalar(begin, p, end, count);
+    }
+#endif  // CIX_HAS_SSSE3
+
+
+    template <bool Count>
+    size_type validate(const char* data, size_type len, size_type& count) noexcept
+    {
+        const auto* begin = reinterpret_cast<const std::uint8_t*>(data);
+        const auto* end = begin + len;
+
+    #if CIX_HAS_AVX2
+        return validate_simd<avx2_ops, Count>(begin, end, count);
+    #elif CIX_HAS_SSSE3
+        return validate_simd<ssse3_ops, Count>(begin, end, count);
+    #else
+        return validate_scalar(begin, begin, end, count);
+    #endif
+    }
+}  // namespace detail::utf8
+
+
+namespace detail
+{
+    // wchar_t is UTF-16 on Windows, UTF-32 elsewhere
+    std::wstring widen(const char* src, size_type len, bool strict)
+    {
+        return detail::utf8::from_utf8<wchar_t>(src, len, strict);
+    }
+
+
+    std::string narrow(const wchar_t* src, size_type len, bool strict)
+    {
+        return detail::utf8::to_utf8(src, len, strict);
+    }
+}  // namespace detail
+
+
+size_type utf8_validate(std::string_view input) noexcept
+{
+    size_type count = 0;
+    return detail::utf8::validate<false>(input.data(), input.size(), count);
+}
+
+
+size_type utf8_count(std::string_view input, size_type* error_offset) noexcept
+{
+    size_type count = 0;
+    const auto error = detail::utf8::validate<true>(
+        input.data(), input.size(), count);
+
+    if (error_offset)
+        *error_offset = error;
+
+    return (error == npos) ? count : npos;
+}
+
+}  // namespace string
+}  // namespace cix
@@ -0,0 +1,586 @@
+// CIX C++ library
+// Copyright (c) Jean-Charles Lefebvre
+// SPDX-License-Identifier: MIT
+
+#include <cix/cix>
+#include <cix/detail/intro.h>
+
+namespace cix {
+namespace path {
+
+namespace detail::walker
+{
+    typedef std::string::size_type size_type;
+
+    // a directory to list, *depth* being the one of its entries
+    struct job_t
+    {
+        std::string path;
+        unsigned depth;
+    };
+
+    // the owner of a queue pushes and pops jobs at its back, so that it walks
+    // depth-first and keeps its queue short, while thieves take the oldest
+    // jobs from the front, which are likely to be the largest subtrees
+    struct alignas(cache_line_size) queue_t
+    {
+        std::mutex mutex;
+        std::deque<job_t> jobs;
+    };
+
+#if CIX_PLATFORM_LINUX
+    // getdents64() is not wrapped by older versions of glibc
+    struct linux_dirent64
+    {
+        std::uint64_t d_ino;
+        std::int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];  // null-terminated, d_reclen - offsetof(d_name) bytes
+    };
+
+    static constexpr std::size_t dents_buffer_size = 64 * 1024;
+#endif
+
+#ifndef _WIN32
+    class scoped_fd : public noncopyable
+    {
+    public:
+        explicit scoped_fd(int fd) : m_fd(fd) { }
+        ~scoped_fd() { if (m_fd >= 0) ::close(m_fd); }
+        int get() const { return m_fd; }
+
+    private:
+        int m_fd;
+    };
+#endif
+
+
+    inline bool ends_with_sep(std::string_view path) noexcept
+    {
+    #if CIX_PLATFORM_WINDOWS
+        return !path.empty() && path::is_sep(path.back());
+    #else
+        return !path.empty() && path.back() == native_sep<char>;
+    #endif
+    }
+
+
+#ifndef _WIN32
+    inline entry_type from_mode(mode_t mode) noexcept
+    {
+        return
+            S_ISREG(mode) ? entry_type::file :
+            S_ISDIR(mode) ? entry_type::directory :
+            S_ISLNK(mode) ? entry_type::symlink :
+            entry_type::other;
+    }
+
+
+    #ifdef DT_UNKNOWN
+    inline entry_type from_dirent_type(unsigned char type) noexcept
+    {
+        switch (type)
+        {
+            case DT_REG:     return entry_type::file;
+            case DT_DIR:     return entry_type::directory;
+            case DT_LNK:     return entry_type::symlink;
+            case DT_UNKNOWN: return entry_type::unknown;
+            default:         return entry_type::other;
+        }
+    }
+    #endif
+#endif
+
+
+    class engine : public noncopyable
+    {
+    public:
+        engine(
+            const walk_callback& callback,
+            const walk_options& options,
+            unsigned threads);
+
+        void run(std::string_view root);
+
+    private:
+        void work(unsigned index);
+        bool pop(unsigned index, job_t& job);
+        void push(unsigned index, std::string_view path, unsigned depth);
+
+        void list(unsigned index, const job_t& job, std::string& path);
+        void on_entry(
+            unsigned index, const job_t& job, std::string& path,
+            size_type base_len, std::string_view name, entry_type type);
+        void on_error(std::string_view path, int error);
+
+        void abort(std::exception_ptr error) noexcept;
+
+        bool stopped() const noexcept
+        {
+            return
+                m_aborted.load(std::memory_order_relaxed) ||
+                (m_options.cancel &&
+                    m_options.cancel->load(std::memory_order_relaxed));
+        }
+
+    private:
+        const walk_callback& m_callback;
+        const walk_options& m_options;
+        const unsigned m_threads;
+
+        std::unique_ptr<queue_t[]> m_queues;
+
+        // number of jobs either queued or being processed
+        std::atomic<size_type> m_pending;
+
+        std::atomic<bool> m_aborted;
+        std::mutex m_error_mutex;
+        std::exception_ptr m_error;
+
+    #ifndef _WIN32
+        // directories listed so far, to avoid cycles when following symlinks
+        std::mutex m_visited_mutex;
+        std::set<std::pair<dev_t, ino_t>> m_visited;
+
+    #if CIX_PLATFORM_LINUX
+        std::unique_ptr<std::unique_ptr<std::uint64_t[]>[]> m_dents_buffers;
+    #endif
+    #endif
+    };
+
+
+    engine::engine(
+            const walk_callback& callback,
+            const walk_options& options,
+            unsigned threads)
+        : m_callback(callback)
+        , m_options(options)
+        , m_threads(threads)
+        , m_queues(new queue_t[threads])
+        , m_pending(0)
+        , m_aborted(false)
+    {
+    #if CIX_PLATFORM_LINUX
+        m_dents_buffers.reset(new std::unique_ptr<std::uint64_t[]>[threads]);
+
+        for (unsigned idx = 0; idx < threads; ++idx)
+        {
+            m_dents_buffers[idx].reset(
+                new std::uint64_t[dents_buffer_size / sizeof(std::uint64_t)]);
+        }
+    #endif
+    }
+
+
+    void engine::run(std::string_view root)
+    {
+        std::vector<std::thread> threads;
+
+        this->push(0, root, 0);
+
+        try
+        {
+            threads.reserve(m_threads - 1);
+
+            for (unsigned idx = 1; idx < m_threads; ++idx)
+                threads.emplace_back(&engine::work, this, idx);
+        }
+        catch (...)
+        {
+            this->abort(std::current_exception());
+        }
+
+        // the calling thread is worker 0
+        this->work(0);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        if (m_error)
+            std::rethrow_exception(m_error);
+    }
+
+
+    void engine::work(unsigned index)
+    {
+        std::string path;  // scratch path of the entries
+        job_t job;
+        unsigned idle = 0;
+
+        while (!this->stopped())
+        {
+            if (this->pop(index, job))
+            {
+                idle = 0;
+
+                try
+                {
+                    this->list(index, job, path);
+                }
+                catch (...)
+                {
+                    this->abort(std::current_exception());
+                }
+
+                m_pending.fetch_sub(1, std::memory_order_acq_rel);
+                continue;
+            }
+
+            // jobs are pushed before their parent is accounted for as
+            // complete, so that nothing can be left once this reaches zero
+            if (m_pending.load(std::memory_order_acquire) == 0)
+                break;
+
+            // back off while other workers list the last directories
+            ++idle;
+            if (idle < 64)
+                cpu_relax();
+            else if (idle < 128)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+
+    bool engine::pop(unsigned index, job_t& job)
+    {
+        {
+            auto& queue = m_queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (!queue.jobs.empty())
+            {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+                return true;
+            }
+        }
+
+        for (unsigned offset = 1; offset < m_threads; ++offset)
+        {
+            auto& queue = m_queues[(index + offset) % m_threads];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (!queue.jobs.empty())
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    void engine::push(unsigned index, std::string_view path, unsigned depth)
+    {
+        auto& queue = m_queues[index];
+
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back({ std::string(path), depth });
+        }
+        catch (...)
+        {
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+    }
+
+
+    void engine::on_entry(
+        unsigned index, const job_t& job, std::string& path,
+        size_type base_len, std::string_view name, entry_type type)
+    {
+        path.resize(base_len);
+        path.append(name);
+
+        const walk_entry entry{
+            path, std::string_view(path).substr(base_len), type, job.depth };
+
+        if ((type != entry_type::directory || m_options.report_dirs) &&
+            (!m_options.filter || m_options.filter(entry)))
+        {
+            m_callback(entry);
+        }
+
+        if (type == entry_type::directory &&
+            job.depth < m_options.max_depth &&
+            (!m_options.dir_filter || m_options.dir_filter(entry)))
+        {
+            this->push(index, path, job.depth + 1);
+        }
+    }
+
+
+    void engine::on_error(std::string_view path, int error)
+    {
+        if (m_options.on_error)
+            m_options.on_error(path, error);
+    }
+
+
+    void engine::abort(std::exception_ptr error) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_error_mutex);
+
+        if (!m_error)
+            m_error = error;
+
+        m_aborted.store(true, std::memory_order_relaxed);
+    }
+
+
+#if CIX_PLATFORM_WINDOWS
+
+    void engine::list(unsigned index, const job_t& job, std::string& path)
+    {
+        path.assign(job.path);
+        if (!ends_with_sep(path))
+            path += native_sep<char>;
+
+        const auto base_len = path.size();
+        auto pattern = string::u8tow(std::string_view(path));
+
+        if (pattern.empty())
+        {
+            this->on_error(job.path, ERROR_INVALID_NAME);
+            return;
+        }
+
+        pattern += L'*';
+
+        WIN32_FIND_DATAW data;
+        const auto find = FindFirstFileExW(
+            pattern.c_str(), FindExInfoBasic, &data, FindExSearchNameMatch,
+            nullptr, FIND_FIRST_EX_LARGE_FETCH);
+
+        if (find == INVALID_HANDLE_VALUE)
+        {
+            const auto error = GetLastError();
+            if (error != ERROR_FILE_NOT_FOUND)
+                this->on_error(job.path, static_cast<int>(error));
+            return;
+        }
+
+        std::unique_ptr<void, decltype(&FindClose)> find_guard(find, &FindClose);
+
+        do
+        {
+            const std::wstring_view wname(data.cFileName);
+
+            if (wname == L"." || wname == L"..")
+                continue;
+
+            const auto attr = data.dwFileAttributes;
+            const auto type =
+                (attr & FILE_ATTRIBUTE_REPARSE_POINT) ? entry_type::symlink :
+                (attr & FILE_ATTRIBUTE_DIRECTORY) ? entry_type::directory :
+                (attr & FILE_ATTRIBUTE_DEVICE) ? entry_type::other :
+                entry_type::file;
+
+            this->on_entry(
+                index, job, path, base_len, string::wtou8repl(wname), type);
+        }
+        while (!this->stopped() && FindNextFileW(find, &data));
+
+        if (!this->stopped())
+        {
+            const auto error = GetLastError();
+            if (error != ERROR_NO_MORE_FILES)
+                this->on_error(job.path, static_cast<int>(error));
+        }
+    }
+
+#else
+
+    void engine::list(unsigned index, const job_t& job, std::string& path)
+    {
+        const scoped_fd fd(::open(
+            job.path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOCTTY));
+
+        if (fd.get() < 0)
+        {
+            this->on_error(job.path, errno);
+            return;
+        }
+
+        if (m_options.follow_symlinks)
+        {
+            struct stat st;
+
+            if (::fstat(fd.get(), &st) != 0)
+            {
+                this->on_error(job.path, errno);
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_visited_mutex);
+
+            if (!m_visited.emplace(st.st_dev, st.st_ino).second)
+                return;
+        }
+
+        path.assign(job.path);
+        if (!ends_with_sep(path))
+            path += native_sep<char>;
+
+        const auto base_len = path.size();
+
+        // stat an entry only if the file system does not tell its type, or
+        // to resolve symlinks if they are to be followed
+        const auto resolve = [this, &fd](const char* name, entry_type type) {
+            if (type == entry_type::unknown ||
+                (type == entry_type::symlink && m_options.follow_symlinks))
+            {
+                struct stat st;
+                const int flags = m_options.follow_symlinks ? 0 : AT_SYMLINK_NOFOLLOW;
+
+                if (::fstatat(fd.get(), name, &st, flags) == 0)
+                    type = from_mode(st.st_mode);
+            }
+
+            return type;
+        };
+
+        const auto is_dot_or_dotdot = [](const char* name) {
+            return
+                name[0] == '.' &&
+                (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+        };
+
+    #if CIX_PLATFORM_LINUX
+        auto* buffer = reinterpret_cast<char*>(m_dents_buffers[index].get());
+
+        while (!this->stopped())
+        {
+            const auto res = ::syscall(
+                SYS_getdents64, fd.get(), buffer, dents_buffer_size);
+
+            if (res < 0)
+            {
+                this->on_error(job.path, errno);
+                break;
+            }
+
+            if (res == 0)
+                break;
+
+            for (long offset = 0; offset < res; )
+            {
+                const auto* dent =
+                    reinterpret_cast<const linux_dirent64*>(buffer + offset);
+                const char* name =
+                    buffer + offset + offsetof(linux_dirent64, d_name);
+
+                offset += dent->d_reclen;
+
+                if (is_dot_or_dotdot(name))
+                    continue;
+
+                this->on_entry(
+                    index, job, path, base_len, name,
+                    resolve(name, from_dirent_type(dent->d_type)));
+            }
+        }
+    #else
+        // fdopendir() takes ownership of its descriptor
+        const int dir_fd = ::dup(fd.get());
+        if (dir_fd < 0)
+        {
+            this->on_error(job.path, errno);
+            return;
+        }
+
+        std::unique_ptr<DIR, decltype(&::closedir)> dir(
+            ::fdopendir(dir_fd), &::closedir);
+        if (!dir)
+        {
+            const int error = errno;
+            ::close(dir_fd);
+            this->on_error(job.path, error);
+            return;
+        }
+
+        while (!this->stopped())
+        {
+            errno = 0;
+            const auto* dent = ::readdir(dir.get());
+
+            if (!dent)
+            {
+                if (errno != 0)
+                    this->on_error(job.path, errno);
+                break;
+            }
+
+            if (is_dot_or_dotdot(dent->d_name))
+                continue;
+
+        #ifdef DT_UNKNOWN
+            const auto type = from_dirent_type(dent->d_type);
+        #else
+            const auto type = entry_type::unknown;
+        #endif
+
+            this->on_entry(
+                index, job, path, base_len, dent->d_name,
+                resolve(dent->d_name, type));
+        }
+    #endif
+    }
+
+#endif  // CIX_PLATFORM_WINDOWS
+}  // namespace detail::walker
+
+
+void walk(
+    std::string_view root,
+    const walk_callback& callback,
+    const walk_options& options)
+{
+#if CIX_PLATFORM_WINDOWS
+    {
+        const auto wroot = string::u8tow(root);
+
+        if (wroot.empty())
+            CIX_THROW_WINERR_N(ERROR_INVALID_NAME, "walk: invalid path \"{}\"", root);
+
+        const auto attr = GetFileAttributesW(wroot.c_str());
+
+        if (attr == INVALID_FILE_ATTRIBUTES)
+            CIX_THROW_WINERR("walk: cannot access \"{}\"", root);
+
+        if (!(attr & FILE_ATTRIBUTE_DIRECTORY))
+            CIX_THROW_WINERR_N(ERROR_DIRECTORY, "walk: not a directory \"{}\"", root);
+    }
+#else
+    {
+        // copied since *root* may not be null-terminated
+        const std::string root_str(root);
+        struct stat st;
+
+        if (::stat(root_str.c_str(), &st) != 0)
+            CIX_THROW_CRTERR("walk: cannot access \"{}\"", root);
+
+        if (!S_ISDIR(st.st_mode))
+            CIX_THROW_CRTERR_N(ENOTDIR, "walk: not a directory \"{}\"", root);
+    }
+#endif
+
+    auto threads = options.threads;
+    if (!threads)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    detail::walker::engine engine(callback, options, threads);
+    engine.run(root);
+}
+
+}  // namespace path
+}  // namespace cix